@@ -12,16 +12,47 @@
 #include <memory>
 #include <algorithm>
 #include <set>
+#include <map>
+#include <deque>
 #include <unordered_set>
 #include <sstream>
 #include <filesystem>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <sys/types.h>
 
 
 using namespace std;
 
 enum LiteralType {ORDER, BOOL_VARIABLE, HELPER, DIRECT, SET_ELEM};
 enum FileType {DIMACS, SMTLIB};
-enum SolverType {MINISAT, CADICAL, GLUCOSE, Z3, CVC5};
+enum SolverType {MINISAT, CADICAL, GLUCOSE, Z3, CVC5, CRYPTOMINISAT};
+enum TimesEncoding {TIMES_AUTO, TIMES_ORDER, TIMES_TABLE, TIMES_BINARY};
+enum Polarity {POLARITY_NONE = 0, POLARITY_POS = 1, POLARITY_NEG = 2, POLARITY_BOTH = 3};
+enum PbEncoding {PB_AUTO, PB_SEQUENTIAL, PB_TOTALIZER, PB_SORTER, PB_BDD};
+
+struct EncoderOptions {
+    TimesEncoding times_encoding = TIMES_AUTO;
+    PbEncoding pb_encoding = PB_AUTO;
+    int xor_chunk = 4;
+    bool xor_clauses = false;
+    bool dedup = true;
+    int subsume_window = 0;
+    bool pipe_solver = false;
+    vector<pair<SolverType, int>> portfolio;
+    string work_dir;
+    int encode_threads = 1;
+    bool incremental = false;
+    bool core_guided = false;
+    bool anytime = false;
+    long long time_limit = 0;
+    long long conflict_limit = 0;
+    chrono::steady_clock::time_point start_time = chrono::steady_clock::now();
+    bool split_proof = false;
+    bool lns = false;
+    int lns_threads = 1;
+};
 
 struct Literal{
     LiteralType type;
@@ -35,6 +66,16 @@ struct Literal{
 using LiteralPtr = shared_ptr<Literal>;
 using Clause = vector<LiteralPtr>;
 using CNF = vector<Clause>; 
+using PbTerms = vector<pair<int, LiteralPtr>>;
+
+// Node of a pseudo-Boolean BDD together with the interval [lower, upper]
+// of bounds for which it represents the same constraint
+struct PbBddNode{
+    long long lower;
+    long long upper;
+    LiteralPtr lit;
+    bool is_true;
+};
 
 struct tuple_hash {
     template <typename T1, typename T2, typename T3>
@@ -70,24 +111,114 @@ struct pair_hash {
     }
 };
 
+// A written clause is remembered by a fingerprint of two independent 64-bit
+// hashes of its sorted literals, instead of a copy of the literals
+struct fingerprint_hash {
+    size_t operator()(const pair<uint64_t, uint64_t> &fingerprint) const noexcept {
+        return fingerprint.first;
+    }
+};
+
+// A constraint encoded by a worker of the parallel encoder. The variables
+// and helpers it introduced are numbered from LOCAL_ID_BASE, and the cache
+// entries it added are kept apart, until it is merged into the formula
+struct EncodedConstraint {
+    static const int LOCAL_ID_BASE = 1 << 30;
+
+    CNF clauses;
+    CNF xor_clauses;
+    int var_num = 0;
+    int helper_num = 0;
+    bool unsat = false;
+    vector<BasicVar*> helper_vars;
+    unordered_map<int, unordered_set<int>> direct_encoded_values;
+    map<vector<int>, BasicVar*> constant_vars;
+    unordered_map<const Parameter*, BasicVar*> param_vars;
+    unordered_map<const Parameter*, ArrayLiteral*> param_arrays;
+    unordered_map<tuple<int, int, int, int>, BasicVar*, substitution_map_hash> encoded_substitutions;
+    map<pair<int, int>, vector<LiteralPtr>> log_bits_map;
+    unordered_map<int, vector<LiteralPtr>> set_suffix_map;
+    unordered_map<int, vector<LiteralPtr>> set_card_map;
+};
+
+// A file of the proof, written through a buffer that is only written out
+// when it grows large, when the file is appended to another one or closed,
+// and not on std::endl. The files of the proof are appended to each other
+// by the kernel, and text can be inserted into them at marked offsets,
+// such as the width of the bit-vectors, which is known only at the end
+class ProofWriter : public ostream {
+public:
+    ProofWriter() : ostream(&buffer) {}
+    ~ProofWriter() { close(); }
+
+    void open(const string &path);
+    void close();
+    void write_out() { buffer.write_out(); }
+    void mark() { marks.push_back(buffer.written + (off_t)buffer.data.size()); }
+    void append(ProofWriter &source, const string &insert = "");
+
+private:
+    struct Buffer : streambuf {
+        static const size_t CAPACITY = 1 << 20;
+
+        int fd = -1;
+        off_t written = 0;
+        string data;
+
+        void write_out();
+        int_type overflow(int_type c) override;
+        streamsize xsputn(const char *s, streamsize n) override;
+    };
+
+    void copy_from(int source_fd, off_t &offset, off_t end);
+
+    Buffer buffer;
+    vector<off_t> marks;
+};
 
 class Encoder {
 public:
-    Encoder(const vector<Item>& items, const FileType fileType, const SolverType solverType, const bool export_proof);
+    Encoder(const vector<Item>& items, const FileType fileType, const SolverType solverType, const bool export_proof,
+            const EncoderOptions& options);
+    ~Encoder();
     CNF encode_to_cnf();
     void write_to_file();
     void run_solver(const string &outputFile);
-    void read_solver_output(const string &outputFile);
+    void read_solver_output(const string &outputFile, ostream &out = cout);
+    void optimize(ostream &out = cout, ostream &log = cerr);
     void generate_proof();
+    void print_statistics(ostream &out = cerr);
 
     bool unsat = false;
 
 private:
 
+    Encoder(const Encoder* parent);
+
+    // Looks a key up in one of the caches shared between the constraints.
+    // A worker of the parallel encoder also sees the entries its parent
+    // encoder had when the worker was started
+    template <typename Map>
+    const typename Map::mapped_type* find_cached(Map Encoder::* cache, const typename Map::key_type& key) const {
+        auto it = (this->*cache).find(key);
+        if (it != (this->*cache).end())
+            return &it->second;
+        if (parent != nullptr) {
+            auto parent_it = (parent->*cache).find(key);
+            if (parent_it != (parent->*cache).end())
+                return &parent_it->second;
+        }
+        return nullptr;
+    }
+
     LiteralPtr make_literal(LiteralType type, int id, bool pol, int val) {
         return make_shared<Literal>(type, id, pol, val);
     }
 
+    LiteralPtr negate_literal(const LiteralPtr& l) {
+        return make_shared<Literal>(l->type, l->id, !l->pol, l->val);
+    }
+
     void cleanup_variant(BasicVarType& var) {
         visit([](auto&& arg) {
             using T = decay_t<decltype(arg)>;
@@ -108,35 +239,40 @@ private:
     }
 
     void cleanup_arrays() {
-        for (ArrayLiteral* arr : allocated_arrays) {
+        for (auto& [param, arr] : param_arrays) {
             for (BasicExpr* expr : *arr) {
                 delete expr;
             }
             delete arr;
         }
-        allocated_arrays.clear();
+        param_arrays.clear();
     }
 
     CNF cnf_clauses;
     const vector<Item>& items;
+    const Encoder* parent = nullptr;
     unordered_map<string, Parameter*> parameter_map;
     unordered_map<string, Variable*> variable_map;
     unordered_map<string, Variable*> array_map; 
     unordered_map<int, Variable*> id_map; 
     unordered_map<tuple<LiteralType, int, int>, int, tuple_hash> literal_to_num;
-    unordered_map<int, LiteralPtr> num_to_literal;
     unordered_map<int, set<int>> set_variable_map;
-    set<ArrayVar*> array_set;
     vector<BasicVar*> helper_vars;
-    vector<ArrayLiteral*> allocated_arrays;
+    unordered_map<const Parameter*, ArrayLiteral*> param_arrays;
+    unordered_map<const Parameter*, BasicVar*> param_vars;
     FileType file_type;
     SolverType solver_type;
+    EncoderOptions options;
 
     bool export_proof = false;
-    ofstream trivial_encoding_vars;
-    ofstream trivial_encoding_constraints;
-    ofstream trivial_encoding_domains;
-    ofstream connection_formula;
+    // Whether a proof is exported at all. export_proof is switched off while
+    // the encoding of another constraint is reused, but encodings whose
+    // helpers have no definition in the proof must stay off then as well
+    bool proof_requested = false;
+    ProofWriter trivial_encoding_vars;
+    ProofWriter trivial_encoding_constraints;
+    ProofWriter trivial_encoding_domains;
+    ProofWriter connection_formula;
     bool isUF = false;
     bool isLIA = false;
     bool isNIA = false;
@@ -162,26 +298,26 @@ private:
     vector<tuple<string, string, string>> set_in_imp_pairs;
     void handle_set_vars();
     void handle_set_in_constraints();
-    void write_ones(ofstream &proof_file);
-    void write_mod_div(ofstream &proof_file);
-    void write_lex(ofstream &proof_file);
+    void write_ones(ostream &proof_file);
+    void write_mod_div(ostream &proof_file);
+    void write_lex(ostream &proof_file);
     int next_array = 1;
     bool is2step = false;
-    ofstream connection2step;
-    ofstream domains2step;
-    ofstream constraints2step1;
-    ofstream constraints2step2;
-    ofstream sat_dom;
-    ofstream sat_constraints;
-    ofstream sat_smt_funs;
-    ofstream smt_sat_funs;
-    ofstream smt_step1_funs;
-    ofstream left_total;
-    ofstream left_total_step1;
-    ofstream right_total;
-    ofstream smt_subspace;
-    ofstream smt_subspace_step1;
-    ofstream sat_subspace;
+    ProofWriter connection2step;
+    ProofWriter domains2step;
+    ProofWriter constraints2step1;
+    ProofWriter constraints2step2;
+    ProofWriter sat_dom;
+    ProofWriter sat_constraints;
+    ProofWriter sat_smt_funs;
+    ProofWriter smt_sat_funs;
+    ProofWriter smt_step1_funs;
+    ProofWriter left_total;
+    ProofWriter left_total_step1;
+    ProofWriter right_total;
+    ProofWriter smt_subspace;
+    ProofWriter smt_subspace_step1;
+    ProofWriter sat_subspace;
     void flush_buffers();
     set<string*> encoded2step;
     int next_constraint_num = 1;
@@ -192,6 +328,38 @@ private:
     int sub_index1 = -1;
     int sub_index2 = -1;
     unordered_map<tuple<int, int, int, int>, BasicVar*, substitution_map_hash> encoded_substitutions;
+    map<pair<int, int>, vector<LiteralPtr>> log_bits_map;
+    unordered_map<int, unordered_set<int>> direct_encoded_values;
+    map<vector<int>, BasicVar*> constant_vars;
+    unordered_map<int, vector<LiteralPtr>> set_suffix_map;
+    unordered_map<int, vector<LiteralPtr>> set_card_map;
+    CNF xor_clauses;
+    vector<pair<set<string>, bool>> xor_rows;
+    vector<Constraint*> xor_row_first;
+    unordered_map<Constraint*, int> xor_row_of;
+    unordered_map<string, int> reif_polarity;
+    unordered_set<pair<uint64_t, uint64_t>, fingerprint_hash> written_clauses;
+    deque<vector<int>> recent_clauses;
+    int duplicate_clause_num = 0;
+    int subsumed_clause_num = 0;
+    pid_t solver_pid = -1;
+    int solver_in = -1;
+    int solver_out = -1;
+    string solver_output;
+    string portfolio_winner;
+    string smt_pending;
+
+    // The DIMACS variables set by the solver's model and their values
+    vector<bool> model_assigned;
+    vector<bool> model_values;
+
+    // The decision variables of large neighbourhood search, grouped by the
+    // output arrays they come from, and the sessions of the LNS threads
+    vector<const BasicVar*> lns_vars;
+    vector<pair<size_t, size_t>> lns_arrays;
+    double lns_free = 0.2;
+    mt19937 lns_random;
+    vector<unique_ptr<Encoder>> lns_workers;
 
     vector<unordered_set<string>> sat_subspace_vars = {{}};
     vector<unordered_set<string>> sat_constraints_vars = {{}};
@@ -218,11 +386,49 @@ private:
     int next_helper_id = 1;
     int clause_num = 0; 
 
+    void encode_constraints_in_parallel(size_t begin, size_t end);
+    EncodedConstraint encode_constraint_in_worker(Constraint &constr);
+    bool merge_encoded_constraint(EncodedConstraint &encoded);
     void declare_unsat(CNF &cnf_clauses);
+    string scratch_path(const string &name) const;
+    int run_in_work_dir(const string &command) const;
     void set_bv_limits();
+    void detect_xor_chains();
+    void analyse_reif_polarity();
+    int get_reif_polarity(const string &name);
     void generate_proof2step();
+    void remove_scratch_files() const;
+    void move_scratch_files(const string &suffix, const string &dir) const;
+    void split_proof_files(const string &dir) const;
+    void split_proof_file(const filesystem::path &path, const filesystem::path &dir) const;
 
     void write_clauses_to_dimacs_file(CNF &cnf_clauses);
+    bool is_new_clause(const vector<int> &clause_nums);
+    void start_solver_process();
+    void write_to_solver(const string &buffer);
+    string read_from_solver();
+    void start_smt_solver();
+    void send_file_to_solver(const string &path);
+    string read_smt_response();
+    long long time_left() const;
+    int poll_timeout() const;
+    void print_answer(ostream &out, const string &status, const string &solution = "") const;
+    void read_smt_model(const string &model);
+    string smt_check(const vector<string> &assumptions);
+    int dimacs_literal(LiteralType type, int id, int val, bool pol) const;
+    BasicVar *get_objective(SolveType &type) const;
+    bool get_objective_softs(SolveType type, const BasicVar &objective, long long &base,
+                             vector<pair<string, long long>> &softs);
+    string optimize_core_guided(vector<pair<string, long long>> softs, long long base, int sign,
+                                string &best, ostream &log);
+    void collect_lns_vars(const BasicVar *objective);
+    bool search_neighbourhoods(const BasicVar &objective, SolveType type, int bound, string &model);
+    void read_model(const char *begin, const char *end);
+    int model_value(LiteralType type, int id, int val) const;
+    bool decode_int(const BasicVar &var, int &value) const;
+    bool format_output_elem(const BasicExpr &elem, string &text) const;
+    void print_model(ostream &out) const;
+    void run_portfolio();
     void write_clauses_to_smtlib_file(CNF &cnf_clauses);
     ArrayLiteral *get_array(Constraint &constr, int ind);
     BasicLiteralExpr* get_const(Constraint &constr, int ind);
@@ -237,16 +443,27 @@ private:
     void encode_variable(Variable& var, CNF& cnf_clauses);
     BasicVar* encode_int_range_helper_variable(const int left, const int right, CNF &cnf_clauses, bool is2step_var = false);
     BasicVar *encode_bool_helper_variable(CNF &cnf_clauses);
-    void encode_direct(const BasicVar &var, CNF &cnf_clauses);
+    void encode_direct_value(const BasicVar &var, int val, CNF &cnf_clauses, CNF *dom_clauses = nullptr);
+    void encode_direct(const BasicVar &var, CNF &cnf_clauses, CNF &dom_clauses);
+    LiteralPtr get_direct_literal(const BasicVar &var, int val, bool pol, CNF &cnf_clauses);
+    LiteralPtr encode_index_selector(const BasicVar &b, int i, CNF &cnf_clauses);
+    BasicVar *get_constant_var(const BasicLiteralExpr &val, CNF &cnf_clauses);
     BasicVar *encode_param_as_var(Parameter &param, CNF &cnf_clauses);
+    bool is_int_const(const BasicExpr &expr, int &val);
+    void encode_int_in_range(const BasicVar &x, long long lo, long long hi, CNF &cnf_clauses);
+    void encode_int_ne_const(const BasicVar &x, long long val, CNF &cnf_clauses);
+    bool encode_const_operand(Constraint &constr, CNF &cnf_clauses);
     BasicVar *get_var(Constraint &constr, int ind, CNF &cnf_clauses);
     void encode_constraint(Constraint &constr, CNF &cnf_clauses);
+    void encode_constraint_clauses(Constraint &constr, CNF &cnf_clauses);
+    void write_constraint_clauses(CNF &cnf_clauses);
 
     bool encode_primitive_comparison_minus(const BasicVar &a, const BasicVar &b, int c, CNF &cnf_clauses);
     bool encode_primitive_comparison_plus(const BasicVar &a, const BasicVar &b, int c, CNF &cnf_clauses);
     void reify(CNF& temp_clauses, const BasicVar& r, CNF& cnf_clauses);
     void reify_helper(CNF &temp_clauses, const LiteralPtr &r, CNF &cnf_clauses);
     void impify(CNF &temp_clauses, const BasicVar &r, CNF &cnf_clauses);
+    void converse_impify(CNF &temp_clauses, const BasicVar &r, CNF &cnf_clauses);
 
     void encode_array_int_element(const BasicVar &b, const ArrayLiteral &as, BasicVar &c, CNF &cnf_clauses);
     void encode_array_int_maximum(const BasicVar &m, const ArrayLiteral &x, CNF &cnf_clauses);
@@ -286,12 +503,21 @@ private:
     void encode_int_pow(const BasicVar &a, const BasicVar &b, const BasicVar &c, CNF &cnf_clauses);
     void encode_int_times_nonnegative(const BasicVar &a, const BasicVar &b, const BasicVar &c, CNF &cnf_clauses);
     void encode_int_times(const BasicVar &a, const BasicVar &b, const BasicVar &c, CNF &cnf_clauses);
+    double estimate_int_times_size(const BasicVar &a, const BasicVar &b, const BasicVar &c, TimesEncoding encoding);
+    void encode_int_times_table(const BasicVar &a, const BasicVar &b, const BasicVar &c, CNF &cnf_clauses);
+    void encode_int_times_binary(const BasicVar &a, const BasicVar &b, const BasicVar &c, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_log_bits(const BasicVar &var, int width, CNF &cnf_clauses);
+    void encode_log_channel(const BasicVar &var, int left, int right, const vector<LiteralPtr> &bits, CNF &cnf_clauses);
+    LiteralPtr encode_and_gate(const LiteralPtr &x, const LiteralPtr &y, CNF &cnf_clauses);
+    pair<LiteralPtr, LiteralPtr> encode_full_adder(const LiteralPtr &x, const LiteralPtr &y, const LiteralPtr &z, CNF &cnf_clauses);
     void encode_set_in(const BasicVar &x, const BasicLiteralExpr &S, CNF &cnf_clauses);
 
     void encode_array_bool_and(const ArrayLiteral &as, const BasicVar &r, CNF &cnf_clauses);
     void encode_array_bool_element(const BasicVar &b, const ArrayLiteral &as, BasicVar &c, CNF &cnf_clauses);
     void encode_array_bool_or(const ArrayLiteral &as, const BasicVar &r, CNF &cnf_clauses);
     void encode_array_bool_xor(const ArrayLiteral &as, CNF &cnf_clauses);
+    void encode_xor(Clause lits, bool parity, CNF &cnf_clauses);
+    void encode_xor_row(int row, CNF &cnf_clauses);
     void encode_array_var_bool_element(const BasicVar &b, const ArrayLiteral &as, BasicVar &c, CNF &cnf_clauses);
     void encode_bool2int(const BasicVar &a, const BasicVar &b, CNF &cnf_clauses);
     void encode_bool_and(const BasicVar &a, const BasicVar &b, const BasicVar &r, CNF &cnf_clauses);
@@ -305,6 +531,16 @@ private:
     void encode_bool_substitution(const BasicVar &x, const BasicVar &x1, int coef1, const BasicVar &x2, int coef2, CNF &cnf_clauses);
     void encode_bool_lin_eq(const ArrayLiteral &coefs, const ArrayLiteral &vars, int c, CNF &cnf_clauses);
     void encode_bool_lin_le(const ArrayLiteral &coefs, const ArrayLiteral &vars, int c, CNF &cnf_clauses);
+    void encode_pb_le(const PbTerms &terms, long long k, CNF &cnf_clauses);
+    double estimate_pb_size(const PbTerms &terms, long long k, PbEncoding encoding);
+    void encode_pb_sequential(const PbTerms &terms, long long k, CNF &cnf_clauses);
+    PbTerms encode_pb_totalizer(const PbTerms &terms, int left, int right, long long k, bool is_root, CNF &cnf_clauses);
+    void encode_pb_sorter(const PbTerms &terms, long long k, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_sorter(const vector<LiteralPtr> &inputs, int m, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_merger(const vector<LiteralPtr> &a, const vector<LiteralPtr> &b, CNF &cnf_clauses);
+    pair<LiteralPtr, LiteralPtr> encode_comparator(const LiteralPtr &x, const LiteralPtr &y, CNF &cnf_clauses);
+    PbBddNode encode_pb_bdd(const PbTerms &terms, const vector<long long> &suffix, int i, long long k,
+                            vector<map<long long, PbBddNode>> &memo, CNF &cnf_clauses);
     void encode_bool_lt(const BasicVar &a, const BasicVar &b, CNF &cnf_clauses);
     void encode_bool_lt_reif(const BasicVar &a, const BasicVar &b, const BasicVar &r, CNF &cnf_clauses);
     void encode_bool_lt_imp(const BasicVar &a, const BasicVar &b, const BasicVar &r, CNF &cnf_clauses);
@@ -318,6 +554,8 @@ private:
     void encode_array_set_element(const BasicVar &b, const ArrayLiteral &as, const BasicVar &c, CNF &cnf_clauses);
     void encode_array_var_set_element(const BasicVar &b, const ArrayLiteral &as, const BasicVar &c, CNF &cnf_clauses);
     void encode_set_substitution(const BasicVar &x, const BasicVar &x1, int val1, int val2, const BasicVar& S, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_unary_sum(const Clause &lits, int left, int right, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_set_totalizer(const BasicVar &S, CNF &cnf_clauses);
     void encode_set_card(const BasicVar &S, const BasicVar &x, CNF &cnf_clauses);
     void encode_set_diff(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
     void encode_set_eq(const BasicVar &x, const BasicVar &y, CNF &cnf_clauses);
@@ -333,6 +571,8 @@ private:
     void encode_set_ne_imp(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
     void encode_set_intersect(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
     void set_max(const BasicVar &x, const BasicVar &set, CNF &cnf_clauses);
+    vector<LiteralPtr> encode_set_suffix(const BasicVar &s, CNF &cnf_clauses);
+    void encode_set_lex(const BasicVar &x, const BasicVar &y, bool strict, const BasicVar *r, bool reified, CNF &cnf_clauses);
     void encode_set_le(const BasicVar &x, const BasicVar &y, CNF &cnf_clauses);
     void encode_set_le_reif(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
     void encode_set_le_imp(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
@@ -349,5 +589,7 @@ private:
     void encode_set_union(const BasicVar &x, const BasicVar &y, const BasicVar &r, CNF &cnf_clauses);
 };
 
+string shell_quote(const string &text);
+
 #endif
 
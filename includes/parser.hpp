@@ -40,7 +40,7 @@
 extern int yydebug;
 #endif
 /* "%code requires" blocks.  */
-#line 15 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 14 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
 
     #include <iostream>
     #include <vector>
@@ -48,6 +48,11 @@ extern int yydebug;
 
     using namespace std;
 
+    #ifndef YY_TYPEDEF_YY_SCANNER_T
+    #define YY_TYPEDEF_YY_SCANNER_T
+    typedef void* yyscan_t;
+    #endif
+
     enum BasicParType{INT, BOOL, SETOFINT};
 
     struct SetRangeLiteral{
@@ -197,12 +202,9 @@ extern int yydebug;
          name(name), args(args) {}
     };
     using AnnotationList = vector<Annotation*>*;
-    
-
-    extern vector<Item>* parsing_result;
 
 
-#line 206 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.hpp"
+#line 208 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.hpp"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -250,7 +252,7 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 242 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 252 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
 
     std::string* str_attr;
     vector<Item>* items_attr;
@@ -286,7 +288,7 @@ union YYSTYPE
     vector<variant<Annotation*, BasicLiteralExpr*>*>* anno_list_attr;
     variant<Annotation*, BasicLiteralExpr*>* ann_expr_attr;
 
-#line 290 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.hpp"
+#line 292 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.hpp"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -295,8 +297,18 @@ typedef union YYSTYPE YYSTYPE;
 #endif
 
 
-extern YYSTYPE yylval;
 
-int yyparse (void);
+int yyparse (vector<Item>* parsing_result, yyscan_t scanner);
+/* "%code provides" blocks.  */
+#line 178 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+
+    int yylex(YYSTYPE* yylval, yyscan_t scanner);
+    void yyerror(vector<Item>* parsing_result, yyscan_t scanner, const char* message);
+
+    // Parses a FlatZinc model into the given items. The parser keeps no
+    // global state, so models can be parsed in several threads at once
+    int parse_flatzinc(FILE* input, vector<Item>* parsing_result);
+
+#line 313 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.hpp"
 
 #endif /* !YY_YY_HOME_UBUNTU_DESKTOP_STUDIJE_MASTERRAD_FLATZINCTOSATCONVERTER_SRC_PARSER_HPP_INCLUDED  */
@@ -1,29 +1,204 @@
 #include "../includes/encoder.hpp"
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <poll.h>
+#include <cstring>
+#include <climits>
+#include <thread>
+#include <atomic>
+
+extern char** environ;
+
+// Opens a file of the proof for writing, truncating it
+void ProofWriter::open(const string& path) {
+
+    close();
+    buffer.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(buffer.fd < 0)
+        cerr << "Cannot open file " << path << "\n";
+}
+
+void ProofWriter::close() {
+
+    if(buffer.fd < 0)
+        return;
+
+    buffer.write_out();
+    ::close(buffer.fd);
+    buffer.fd = -1;
+    buffer.written = 0;
+    marks.clear();
+}
+
+// Appends a file of the proof to this one. The text to insert is written
+// at each offset the source file has marked, and the rest of the source
+// file is copied by the kernel
+void ProofWriter::append(ProofWriter& source, const string& insert) {
+
+    source.write_out();
+    write_out();
+    if(buffer.fd < 0 || source.buffer.fd < 0)
+        return;
+
+    off_t offset = 0;
+    for(off_t mark : source.marks){
+        copy_from(source.buffer.fd, offset, mark);
+        *this << insert;
+        write_out();
+    }
+    copy_from(source.buffer.fd, offset, source.buffer.written);
+}
+
+// Copies the bytes of a file from offset up to end to the end of this
+// file. copy_file_range may not copy between file systems, and sendfile
+// and plain reads are used for what it does not copy
+void ProofWriter::copy_from(int source_fd, off_t& offset, off_t end) {
+
+    while(offset < end){
+        ssize_t n = copy_file_range(source_fd, &offset, buffer.fd, nullptr, end - offset, 0);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        buffer.written += n;
+    }
+
+    while(offset < end){
+        ssize_t n = sendfile(buffer.fd, source_fd, &offset, end - offset);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        buffer.written += n;
+    }
+
+    char chunk[1 << 16];
+    while(offset < end){
+        ssize_t n = pread(source_fd, chunk, min<off_t>(sizeof(chunk), end - offset), offset);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        offset += n;
+        buffer.data.append(chunk, n);
+        buffer.write_out();
+    }
+}
+
+void ProofWriter::Buffer::write_out() {
+
+    size_t done = 0;
+    while(fd >= 0 && done < data.size()){
+        ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        done += n;
+    }
+
+    written += done;
+    data.clear();
+}
+
+ProofWriter::Buffer::int_type ProofWriter::Buffer::overflow(int_type c) {
+
+    if(c != traits_type::eof()){
+        data.push_back(traits_type::to_char_type(c));
+        if(data.size() >= CAPACITY)
+            write_out();
+    }
+    return traits_type::not_eof(c);
+}
+
+streamsize ProofWriter::Buffer::xsputn(const char* s, streamsize n) {
+
+    data.append(s, n);
+    if(data.size() >= CAPACITY)
+        write_out();
+    return n;
+}
 
-Encoder::Encoder(const vector<Item> &items, const FileType file_type, const SolverType solver_type, bool export_proof) 
-: items(items), file_type(file_type), solver_type(solver_type), export_proof(export_proof) { 
+Encoder::Encoder(const vector<Item> &items, const FileType file_type, const SolverType solver_type, bool export_proof,
+                 const EncoderOptions& options) 
+: items(items), file_type(file_type), solver_type(solver_type), options(options), export_proof(export_proof), proof_requested(export_proof) { 
 
     if(export_proof){
-        trivial_encoding_vars = ofstream("trivial_encoding_vars.smt2", ios::out);
-        trivial_encoding_constraints = ofstream("trivial_encoding_constraints.smt2", ios::out);
-        trivial_encoding_domains = ofstream("trivial_encoding_domains.smt2", ios::out);
-        connection_formula = ofstream("connection_formula.smt2", ios::out);
-        connection2step = ofstream("connection2step.smt2", ios::out);
-        domains2step = ofstream("domains2step.smt2", ios::out);
-        constraints2step1 = ofstream("constraints2step1.smt2", ios::out);
-        constraints2step2 = ofstream("constraints2step2.smt2", ios::out);
-        sat_dom = ofstream("sat_dom.smt2", ios::out);
-        sat_constraints = ofstream("sat_constraints.smt2", ios::out);
-        sat_smt_funs = ofstream("sat_smt_funs.smt2", ios::out);
-        smt_sat_funs = ofstream("smt_sat_funs.smt2", ios::out);
-        smt_step1_funs = ofstream("smt_step1_funs.smt2", ios::out);
-        left_total = ofstream("left_total.smt2", ios::out);
-        left_total_step1 = ofstream("left_total_step1.smt2", ios::out);
-        right_total = ofstream("right_total.smt2", ios::out);
-        smt_subspace = ofstream("smt_subspace.smt2", ios::out);
-        smt_subspace_step1 = ofstream("smt_subspace_step1.smt2", ios::out);
-        sat_subspace = ofstream("sat_subspace.smt2", ios::out);
+        trivial_encoding_vars.open(scratch_path("trivial_encoding_vars.smt2"));
+        trivial_encoding_constraints.open(scratch_path("trivial_encoding_constraints.smt2"));
+        trivial_encoding_domains.open(scratch_path("trivial_encoding_domains.smt2"));
+        connection_formula.open(scratch_path("connection_formula.smt2"));
+        connection2step.open(scratch_path("connection2step.smt2"));
+        domains2step.open(scratch_path("domains2step.smt2"));
+        constraints2step1.open(scratch_path("constraints2step1.smt2"));
+        constraints2step2.open(scratch_path("constraints2step2.smt2"));
+        sat_dom.open(scratch_path("sat_dom.smt2"));
+        sat_constraints.open(scratch_path("sat_constraints.smt2"));
+        sat_smt_funs.open(scratch_path("sat_smt_funs.smt2"));
+        smt_sat_funs.open(scratch_path("smt_sat_funs.smt2"));
+        smt_step1_funs.open(scratch_path("smt_step1_funs.smt2"));
+        left_total.open(scratch_path("left_total.smt2"));
+        left_total_step1.open(scratch_path("left_total_step1.smt2"));
+        right_total.open(scratch_path("right_total.smt2"));
+        smt_subspace.open(scratch_path("smt_subspace.smt2"));
+        smt_subspace_step1.open(scratch_path("smt_subspace_step1.smt2"));
+        sat_subspace.open(scratch_path("sat_subspace.smt2"));
+    }
+}
+
+// Creates a worker of the parallel encoder. It gets its own copy of what
+// the constraints read, and looks into the caches of its parent for the
+// entries that it has not added itself
+Encoder::Encoder(const Encoder* parent)
+: items(parent->items), parent(parent), parameter_map(parent->parameter_map), variable_map(parent->variable_map),
+  array_map(parent->array_map), id_map(parent->id_map), set_variable_map(parent->set_variable_map),
+  file_type(parent->file_type), solver_type(parent->solver_type), options(parent->options) {
+
+    xor_rows = parent->xor_rows;
+    xor_row_first = parent->xor_row_first;
+    xor_row_of = parent->xor_row_of;
+    reif_polarity = parent->reif_polarity;
+}
+
+// Frees the parameter arrays converted for the constraints, which the
+// encoder owns for the whole run
+Encoder::~Encoder() {
+    cleanup_arrays();
+}
+
+// Returns the path of a scratch file, placed in the working directory
+// given by the options, or in the current one
+string Encoder::scratch_path(const string& name) const {
+    if(options.work_dir.empty())
+        return name;
+    return options.work_dir + "/" + name;
+}
+
+// Quotes a word for the shell. Every single quote in it ends the quoted
+// string, is escaped, and starts a new quoted string
+string shell_quote(const string& text){
+    string quoted = "'";
+    for(char c : text){
+        if(c == '\'')
+            quoted += "'\\''";
+        else
+            quoted += c;
     }
+    return quoted + "'";
+}
+
+// Runs a shell command from the working directory, so that the scratch
+// files can be referred to by their names
+int Encoder::run_in_work_dir(const string& command) const {
+    if(options.work_dir.empty())
+        return system(command.c_str());
+    return system(("cd " + shell_quote(options.work_dir) + " && " + command).c_str());
 }
 
 // Declares the problem to be unsat
@@ -80,23 +255,290 @@ void Encoder::set_bv_limits(){
     }
 }
 
+// Collects the bool_xor and array_bool_xor constraints as parity rows and
+// merges two rows whenever a variable is used only by them, which joins
+// chains of xor constraints over introduced variables into a single row
+void Encoder::detect_xor_chains(){
+
+    unordered_map<string, BasicVar*> bool_vars;
+    unordered_set<string> protected_names;
+    unordered_map<string, int> constraint_refs;
+    unordered_map<string, int> xor_refs;
+
+    auto count_refs = [&](const BasicExpr* expr, unordered_map<string, int>& refs){
+        if(holds_alternative<string*>(*expr))
+            refs[*get<string*>(*expr)]++;
+    };
+
+    for(auto& item : items){
+        if(holds_alternative<Variable*>(item)){
+            auto var = *get<Variable*>(item);
+            if(holds_alternative<BasicVar*>(var)){
+                auto basic_var = get<BasicVar*>(var);
+                if(holds_alternative<BasicParType>(*basic_var->type) &&
+                   get<BasicParType>(*basic_var->type) == BasicParType::BOOL)
+                    bool_vars[*basic_var->name] = basic_var;
+                if(basic_var->is_output)
+                    protected_names.insert(*basic_var->name);
+                if(basic_var->value != nullptr && holds_alternative<string*>(*basic_var->value))
+                    protected_names.insert(*get<string*>(*basic_var->value));
+            } else {
+                auto array_var = get<ArrayVar*>(var);
+                if(array_var->value != nullptr)
+                    for(auto expr : *array_var->value)
+                        if(holds_alternative<string*>(*expr))
+                            protected_names.insert(*get<string*>(*expr));
+            }
+        } else if(holds_alternative<Solve*>(item)){
+            auto solve = get<Solve*>(item);
+            if(solve->type != ORDINARY && holds_alternative<string*>(*solve->expr))
+                protected_names.insert(*get<string*>(*solve->expr));
+        }
+    }
+
+    for(auto& item : items){
+        if(!holds_alternative<Constraint*>(item))
+            continue;
+
+        auto constr = get<Constraint*>(item);
+        for(auto arg : *constr->args){
+            if(holds_alternative<BasicExpr*>(*arg))
+                count_refs(get<BasicExpr*>(*arg), constraint_refs);
+            else
+                for(auto expr : *get<ArrayLiteral*>(*arg))
+                    count_refs(expr, constraint_refs);
+        }
+
+        vector<BasicExpr*> exprs;
+        bool parity = true;
+        if(*constr->name == "bool_xor"){
+            for(auto arg : *constr->args)
+                if(holds_alternative<BasicExpr*>(*arg))
+                    exprs.push_back(get<BasicExpr*>(*arg));
+            if(exprs.size() != constr->args->size())
+                continue;
+            parity = constr->args->size() == 2;
+        } else if(*constr->name == "array_bool_xor" && holds_alternative<ArrayLiteral*>(*(*constr->args)[0])){
+            auto as = get<ArrayLiteral*>(*(*constr->args)[0]);
+            exprs.assign(as->begin(), as->end());
+        } else {
+            continue;
+        }
+
+        // Rows are made only of bool variables and constants
+        set<string> row;
+        bool valid = true;
+        for(auto expr : exprs){
+            if(holds_alternative<string*>(*expr)){
+                string name = *get<string*>(*expr);
+                if(bool_vars.find(name) == bool_vars.end()){
+                    valid = false;
+                    break;
+                }
+                if(!row.insert(name).second)
+                    row.erase(name);
+            } else {
+                auto literal = *get<BasicLiteralExpr*>(*expr);
+                if(!holds_alternative<bool>(literal)){
+                    valid = false;
+                    break;
+                }
+                parity ^= get<bool>(literal);
+            }
+        }
+
+        if(!valid)
+            continue;
+
+        for(auto expr : exprs)
+            count_refs(expr, xor_refs);
+
+        xor_row_of[constr] = xor_rows.size();
+        xor_row_first.push_back(constr);
+        xor_rows.push_back({row, parity});
+    }
+
+    unordered_map<string, set<int>> occurrences;
+    for(int i = 0; i < (int)xor_rows.size(); i++)
+        for(auto& name : xor_rows[i].first)
+            occurrences[name].insert(i);
+
+    vector<int> merged_into(xor_rows.size());
+    for(int i = 0; i < (int)xor_rows.size(); i++)
+        merged_into[i] = i;
+
+    for(auto& [name, refs] : xor_refs){
+        if(protected_names.count(name) || constraint_refs[name] != refs)
+            continue;
+        if(occurrences[name].size() != 2)
+            continue;
+
+        // The smaller row is merged into the larger one
+        int i = *occurrences[name].begin();
+        int j = *occurrences[name].rbegin();
+        if(xor_rows[i].first.size() < xor_rows[j].first.size())
+            swap(i, j);
+
+        for(auto& other : xor_rows[j].first){
+            occurrences[other].erase(j);
+            if(xor_rows[i].first.erase(other)){
+                occurrences[other].erase(i);
+            } else {
+                xor_rows[i].first.insert(other);
+                occurrences[other].insert(i);
+            }
+        }
+        xor_rows[i].second ^= xor_rows[j].second;
+        xor_rows[j].first.clear();
+        merged_into[j] = i;
+    }
+
+    // Each row is encoded at the first of the constraints it was made of
+    for(auto& [constr, row] : xor_row_of){
+        while(merged_into[row] != row)
+            row = merged_into[row];
+    }
+
+    vector<bool> seen(xor_rows.size(), false);
+    for(auto& item : items){
+        if(!holds_alternative<Constraint*>(item))
+            continue;
+
+        auto constr = get<Constraint*>(item);
+        auto it = xor_row_of.find(constr);
+        if(it != xor_row_of.end() && !seen[it->second]){
+            seen[it->second] = true;
+            xor_row_first[it->second] = constr;
+        }
+    }
+}
+
+// Finds in which polarities the result r of each reified constraint is
+// used by the other constraints. Variables observed from outside, such as
+// output variables and the objective, count as used in both polarities
+void Encoder::analyse_reif_polarity(){
+
+    unordered_set<string> protected_names;
+    unordered_map<string, int> definitions;
+    unordered_map<string, int> polarity;
+
+    for(auto& item : items){
+        if(holds_alternative<Variable*>(item)){
+            auto var = *get<Variable*>(item);
+            if(holds_alternative<BasicVar*>(var)){
+                auto basic_var = get<BasicVar*>(var);
+                if(basic_var->is_output)
+                    protected_names.insert(*basic_var->name);
+                if(basic_var->value != nullptr && holds_alternative<string*>(*basic_var->value))
+                    protected_names.insert(*get<string*>(*basic_var->value));
+            } else {
+                auto array_var = get<ArrayVar*>(var);
+                if(array_var->value != nullptr)
+                    for(auto expr : *array_var->value)
+                        if(holds_alternative<string*>(*expr))
+                            protected_names.insert(*get<string*>(*expr));
+            }
+        } else if(holds_alternative<Solve*>(item)){
+            auto solve = get<Solve*>(item);
+            if(solve->type != ORDINARY && holds_alternative<string*>(*solve->expr))
+                protected_names.insert(*get<string*>(*solve->expr));
+        }
+    }
+
+    for(auto& item : items){
+        if(!holds_alternative<Constraint*>(item))
+            continue;
+
+        auto constr = get<Constraint*>(item);
+        const string& name = *constr->name;
+        int arg_num = constr->args->size();
+        bool is_reif = name.size() > 5 && name.compare(name.size() - 5, 5, "_reif") == 0;
+
+        // The polarity in which the elements of the first argument are used,
+        // when the second argument is the constant c
+        auto get_array_polarity = [&](bool c) -> int {
+            auto arg = *(*constr->args)[1];
+            if(!holds_alternative<BasicExpr*>(arg) || !holds_alternative<BasicLiteralExpr*>(*get<BasicExpr*>(arg)))
+                return POLARITY_BOTH;
+            auto literal = *get<BasicLiteralExpr*>(*get<BasicExpr*>(arg));
+            return holds_alternative<bool>(literal) && get<bool>(literal) == c ? (c ? POLARITY_POS : POLARITY_NEG) : POLARITY_BOTH;
+        };
+
+        for(int i = 0; i < arg_num; i++){
+            int arg_polarity = POLARITY_BOTH;
+            if(name == "bool_clause")
+                arg_polarity = i == 0 ? POLARITY_POS : POLARITY_NEG;
+            else if(name == "array_bool_or" && i == 0)
+                arg_polarity = get_array_polarity(true);
+            else if(name == "array_bool_and" && i == 0)
+                arg_polarity = get_array_polarity(false);
+
+            vector<BasicExpr*> exprs;
+            auto arg = *(*constr->args)[i];
+            if(holds_alternative<BasicExpr*>(arg))
+                exprs.push_back(get<BasicExpr*>(arg));
+            else
+                exprs = *get<ArrayLiteral*>(arg);
+
+            for(auto expr : exprs){
+                if(!holds_alternative<string*>(*expr))
+                    continue;
+
+                string var_name = *get<string*>(*expr);
+                if(is_reif && i == arg_num - 1)
+                    definitions[var_name]++;
+                else
+                    polarity[var_name] |= arg_polarity;
+            }
+        }
+    }
+
+    for(auto& [var_name, count] : definitions){
+        if(count == 1 && !protected_names.count(var_name))
+            reif_polarity[var_name] = polarity[var_name];
+        else
+            reif_polarity[var_name] = POLARITY_BOTH;
+    }
+}
+
+int Encoder::get_reif_polarity(const string& name){
+    auto it = reif_polarity.find(name);
+    return it == reif_polarity.end() ? POLARITY_BOTH : it->second;
+}
+
 // Passes through the list of items which constitute the problem
 // and calls the appropriate encoder function
 CNF Encoder::encode_to_cnf() {
 
     if(export_proof)
         set_bv_limits();
+    else {
+        detect_xor_chains();
+        analyse_reif_polarity();
+    }
 
 
-    for (auto& item : items) {
+    // The proof is written while the constraints are encoded, so it needs them in order
+    bool parallel = options.encode_threads > 1 && !export_proof;
+
+    for (size_t i = 0; i < items.size(); i++) {
+            auto& item = items[i];
             if(unsat)
                 break;
             else if(holds_alternative<Parameter*>(item))
                 encode_parameter(*get<Parameter*>(item), cnf_clauses);
             else if(holds_alternative<Variable*>(item))
                 encode_variable(*get<Variable*>(item), cnf_clauses);
-            else if(holds_alternative<Constraint*>(item))
+            else if(holds_alternative<Constraint*>(item) && parallel){
+                size_t end = i;
+                while(end < items.size() && holds_alternative<Constraint*>(items[end]))
+                    end++;
+                encode_constraints_in_parallel(i, end);
+                i = end - 1;
+            } else if(holds_alternative<Constraint*>(item))
                 encode_constraint(*get<Constraint*>(item), cnf_clauses);
+            else if(holds_alternative<Solve*>(item))
+                continue;
             else{
                 cerr << "Unknown item type in encoder\n";
                 break;
@@ -106,12 +548,181 @@ CNF Encoder::encode_to_cnf() {
     return cnf_clauses;
 }
 
+// Encodes the constraints items[begin..end) with a pool of workers. The
+// constraints are taken in windows: the workers encode the constraints of
+// a window independently, and then they are merged in their order, which
+// numbers the variables, the helpers and the DIMACS literals exactly as
+// encoding them one after the other would
+void Encoder::encode_constraints_in_parallel(size_t begin, size_t end){
+
+    int threads = options.encode_threads;
+    size_t window = 256 * (size_t)threads;
+    vector<unique_ptr<Encoder>> workers(threads);
+
+    for(size_t start = begin; start < end && !unsat; start += window){
+        size_t stop = min(end, start + window);
+        vector<EncodedConstraint> encoded(stop - start);
+        atomic<size_t> next_constraint{start};
+
+        auto work = [&](int t){
+            if(workers[t] == nullptr)
+                workers[t].reset(new Encoder(this));
+            size_t i;
+            while((i = next_constraint++) < stop)
+                encoded[i - start] = workers[t]->encode_constraint_in_worker(*get<Constraint*>(items[i]));
+        };
+
+        vector<thread> pool;
+        for(int t = 0; t < threads; t++)
+            pool.emplace_back(work, t);
+        for(auto& t : pool)
+            t.join();
+
+        for(size_t i = start; i < stop && !unsat; i++){
+            if(!merge_encoded_constraint(encoded[i - start]))
+                encode_constraint_clauses(*get<Constraint*>(items[i]), cnf_clauses);
+            write_constraint_clauses(cnf_clauses);
+        }
+    }
+}
+
+// Encodes a constraint in a worker, numbering the new variables and
+// helpers from LOCAL_ID_BASE
+EncodedConstraint Encoder::encode_constraint_in_worker(Constraint& constr){
+
+    next_var_id = EncodedConstraint::LOCAL_ID_BASE;
+    next_helper_id = EncodedConstraint::LOCAL_ID_BASE;
+    unsat = false;
+
+    encode_constraint_clauses(constr, cnf_clauses);
+
+    EncodedConstraint encoded;
+    encoded.clauses.swap(cnf_clauses);
+    encoded.xor_clauses.swap(xor_clauses);
+    encoded.var_num = next_var_id - EncodedConstraint::LOCAL_ID_BASE;
+    encoded.helper_num = next_helper_id - EncodedConstraint::LOCAL_ID_BASE;
+    encoded.unsat = unsat;
+    encoded.helper_vars.swap(helper_vars);
+    encoded.direct_encoded_values.swap(direct_encoded_values);
+    encoded.constant_vars.swap(constant_vars);
+    encoded.param_vars.swap(param_vars);
+    encoded.param_arrays.swap(param_arrays);
+    encoded.encoded_substitutions.swap(encoded_substitutions);
+    encoded.log_bits_map.swap(log_bits_map);
+    encoded.set_suffix_map.swap(set_suffix_map);
+    encoded.set_card_map.swap(set_card_map);
+    return encoded;
+}
+
+// Adds a constraint encoded by a worker to cnf_clauses, giving its
+// variables and helpers the next ids. Returns false, and adds nothing,
+// when the constraint has cached an entry that a constraint merged after
+// the worker was started has also cached, as it would have reused that one
+bool Encoder::merge_encoded_constraint(EncodedConstraint& encoded){
+
+    const int base = EncodedConstraint::LOCAL_ID_BASE;
+    auto var_id = [&](int id){ return id < base ? id : next_var_id + id - base; };
+    auto remap = [&](const LiteralPtr& l){
+        if(l->id >= base)
+            l->id = l->type == LiteralType::HELPER ? next_helper_id + l->id - base : var_id(l->id);
+    };
+
+    // Parameter arrays are the same whichever constraint converts them first
+    for(auto& [param, arr] : encoded.param_arrays){
+        if(!param_arrays.emplace(param, arr).second){
+            for(BasicExpr* expr : *arr)
+                delete expr;
+            delete arr;
+        }
+    }
+
+    bool reused = false;
+    for(auto& [id, values] : encoded.direct_encoded_values){
+        auto it = direct_encoded_values.find(var_id(id));
+        for(int val : values)
+            reused = reused || (it != direct_encoded_values.end() && it->second.count(val) > 0);
+    }
+    for(auto& entry : encoded.constant_vars)
+        reused = reused || constant_vars.count(entry.first) > 0;
+    for(auto& entry : encoded.param_vars)
+        reused = reused || param_vars.count(entry.first) > 0;
+    for(auto& entry : encoded.encoded_substitutions){
+        auto [id0, coef0, id1, coef1] = entry.first;
+        reused = reused || encoded_substitutions.count({var_id(id0), coef0, var_id(id1), coef1}) > 0;
+    }
+    for(auto& entry : encoded.log_bits_map)
+        reused = reused || log_bits_map.count({var_id(entry.first.first), entry.first.second}) > 0;
+    for(auto& entry : encoded.set_suffix_map)
+        reused = reused || set_suffix_map.count(var_id(entry.first)) > 0;
+    for(auto& entry : encoded.set_card_map)
+        reused = reused || set_card_map.count(var_id(entry.first)) > 0;
+
+    helper_vars.insert(helper_vars.end(), encoded.helper_vars.begin(), encoded.helper_vars.end());
+    if(reused)
+        return false;
+
+    for(BasicVar* var : encoded.helper_vars){
+        var->id = var_id(var->id);
+        *var->name = "sub_" + to_string(var->id);
+    }
+    for(auto& clause : encoded.clauses)
+        for(auto& l : clause)
+            remap(l);
+    for(auto& clause : encoded.xor_clauses)
+        for(auto& l : clause)
+            remap(l);
+
+    for(auto& [id, values] : encoded.direct_encoded_values)
+        direct_encoded_values[var_id(id)].insert(values.begin(), values.end());
+    constant_vars.insert(encoded.constant_vars.begin(), encoded.constant_vars.end());
+    param_vars.insert(encoded.param_vars.begin(), encoded.param_vars.end());
+    for(auto& [key, var] : encoded.encoded_substitutions){
+        auto [id0, coef0, id1, coef1] = key;
+        encoded_substitutions[{var_id(id0), coef0, var_id(id1), coef1}] = var;
+    }
+    for(auto& [key, bits] : encoded.log_bits_map){
+        for(auto& l : bits)
+            remap(l);
+        log_bits_map[{var_id(key.first), key.second}] = bits;
+    }
+    for(auto& [id, suffix] : encoded.set_suffix_map){
+        for(auto& l : suffix)
+            remap(l);
+        set_suffix_map[var_id(id)] = suffix;
+    }
+    for(auto& [id, card] : encoded.set_card_map){
+        for(auto& l : card)
+            remap(l);
+        set_card_map[var_id(id)] = card;
+    }
+
+    next_var_id += encoded.var_num;
+    next_helper_id += encoded.helper_num;
+    for(auto& clause : encoded.clauses)
+        cnf_clauses.push_back(move(clause));
+    for(auto& clause : encoded.xor_clauses)
+        xor_clauses.push_back(move(clause));
+    if(encoded.unsat)
+        unsat = true;
+
+    return true;
+}
+
 // Converts the encoded problem to the DIMACS format
 // and writes the output to the file specified by user
 void Encoder::write_to_file(){
 
+    // The solver has already received the clauses, closing its input lets it start solving
+    if(options.pipe_solver){
+        if(solver_in >= 0){
+            close(solver_in);
+            solver_in = -1;
+        }
+        return;
+    }
+
     if(file_type == DIMACS){
-        ofstream file("helper1.cnf");
+        ofstream file(scratch_path("helper1.cnf"));
 
         if (!file.is_open()){
             cerr << "Cannot open file\n";
@@ -124,13 +735,13 @@ void Encoder::write_to_file(){
 
         string command = "cat helper1.cnf helper2.cnf > formula.cnf";
 
-        system(command.c_str());
+        run_in_work_dir(command);
 
         command = "rm helper1.cnf helper2.cnf";
 
-        system(command.c_str());
+        run_in_work_dir(command);
     } else if(file_type == SMTLIB){
-        ofstream file1("helper1.smt2");
+        ofstream file1(scratch_path("helper1.smt2"));
 
         if (!file1.is_open()){
             cerr << "Cannot open file helper1.smt2\n";
@@ -145,30 +756,96 @@ void Encoder::write_to_file(){
 
         file1.close();
 
-        ofstream file2("helper3.smt2");
-        file2 << ")\n" << ")\n" << "(check-sat)\n" << "(get-model)\n";
+        // In an incremental session the checks are sent by optimize
+        ofstream file2(scratch_path("helper3.smt2"));
+        file2 << ")\n" << ")\n";
+        if(!options.incremental)
+            file2 << "(check-sat)\n" << "(get-model)\n";
         file2.close();
 
         string command = "cat helper1.smt2 helper2.smt2 helper3.smt2 > formula.smt2";
 
-        system(command.c_str());
+        run_in_work_dir(command);
 
         command = "rm helper1.smt2 helper2.smt2 helper3.smt2";
 
-        system(command.c_str());
+        run_in_work_dir(command);
+
+    }
+}
+
+// Mixes the bits of a 64-bit value (the finalizer of splitmix64)
+uint64_t mix_bits(uint64_t x){
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Computes the fingerprint of a clause with sorted literals. Two different
+// clauses are only taken for the same one if both of its hashes collide
+pair<uint64_t, uint64_t> clause_fingerprint(const vector<int>& clause){
+    uint64_t h1 = clause.size();
+    uint64_t h2 = 0x9e3779b97f4a7c15ULL;
+    for(int l : clause){
+        uint64_t x = static_cast<uint32_t>(l);
+        h1 = mix_bits(h1 ^ (x + 0x9e3779b97f4a7c15ULL));
+        h2 = mix_bits(h2 + x * 0xd6e8feb86659fd93ULL);
+    }
+    return {h1, h2};
+}
+
+// Checks whether a clause, given by its DIMACS literals, adds anything to
+// the clauses written so far. Clauses are compared by the fingerprints of
+// their sorted literals, and optionally checked for subsumption by the
+// most recent ones
+bool Encoder::is_new_clause(const vector<int>& clause_nums){
 
+    if(!options.dedup && options.subsume_window == 0)
+        return true;
+
+    vector<int> key = clause_nums;
+    sort(key.begin(), key.end());
+    key.erase(unique(key.begin(), key.end()), key.end());
+
+    if(options.dedup && !written_clauses.insert(clause_fingerprint(key)).second){
+        duplicate_clause_num++;
+        return false;
+    }
+
+    if(options.subsume_window > 0){
+        for(auto& recent : recent_clauses){
+            if(recent.size() <= key.size() && includes(key.begin(), key.end(), recent.begin(), recent.end())){
+                subsumed_clause_num++;
+                return false;
+            }
+        }
+
+        recent_clauses.push_back(key);
+        if((int)recent_clauses.size() > options.subsume_window)
+            recent_clauses.pop_front();
     }
+
+    return true;
 }
 
 //Writes the clauses currently present to a DIMACS file and clears 
 //the cnf_clauses vector
 void Encoder::write_clauses_to_dimacs_file(CNF& cnf_clauses) {
-    ofstream file("helper2.cnf", ios::app);
+    ofstream file;
+    if (!options.pipe_solver)
+        file.open(scratch_path("helper2.cnf"), ios::app);
 
     string buffer;
     buffer.reserve(1 << 20); 
 
-    for (const auto& clause : cnf_clauses) {
+    // Native XOR clauses follow the ordinary ones, marked with an x prefix
+    int ordinary_num = cnf_clauses.size();
+    for (int i = 0; i < ordinary_num + (int)xor_clauses.size(); i++) {
+        const Clause& clause = i < ordinary_num ? cnf_clauses[i] : xor_clauses[i - ordinary_num];
+        vector<int> clause_nums;
+
         for (const auto& l : clause) {
 
             auto key = make_tuple(l->type, l->id, l->val);
@@ -179,10 +856,6 @@ void Encoder::write_clauses_to_dimacs_file(CNF& cnf_clauses) {
 
                 lit_num = next_dimacs_num++;
                 literal_to_num[key] = lit_num;
-                if (l->type == LiteralType::ORDER || 
-                    l->type == LiteralType::BOOL_VARIABLE || 
-                    l->type == LiteralType::SET_ELEM)
-                    num_to_literal[lit_num] = l;
 
                 if(export_proof){
                     if(l->type == LiteralType::ORDER){
@@ -280,32 +953,67 @@ void Encoder::write_clauses_to_dimacs_file(CNF& cnf_clauses) {
                 lit_num = it->second;
             }
 
-            buffer.append(to_string(l->pol ? lit_num : -lit_num));
+            clause_nums.push_back(l->pol ? lit_num : -lit_num);
+        }
+
+        if (i < ordinary_num && !is_new_clause(clause_nums))
+            continue;
+
+        if (i >= ordinary_num)
+            buffer.push_back('x');
+        for (int lit_num : clause_nums) {
+            buffer.append(to_string(lit_num));
             buffer.push_back(' ');
         }
         buffer.append("0\n");
         clause_num++;
 
         if (buffer.size() > (1 << 20)) {
-            file.write(buffer.data(), buffer.size());
+            if (options.pipe_solver)
+                write_to_solver(buffer);
+            else
+                file.write(buffer.data(), buffer.size());
             buffer.clear();
         }
     }
 
-    if (!buffer.empty())
-        file.write(buffer.data(), buffer.size());
-    file.flush();
+    if (!buffer.empty()) {
+        if (options.pipe_solver)
+            write_to_solver(buffer);
+        else
+            file.write(buffer.data(), buffer.size());
+    }
+    if (!options.pipe_solver)
+        file.flush();
 
     file.close();
 
     if(!export_proof)
         CNF().swap(cnf_clauses);
+    xor_clauses.clear();
+}
+
+// Prints the size of the formula and how many clauses were left out of it
+// as MiniZinc statistics, by default on the error output
+void Encoder::print_statistics(ostream& out){
+
+    int emitted_num = clause_num + duplicate_clause_num + subsumed_clause_num;
+    double dedup_rate = emitted_num == 0 ? 0 : (double)duplicate_clause_num / emitted_num;
+
+    out << "%%%mzn-stat: variables=" << next_dimacs_num - 1 << "\n";
+    out << "%%%mzn-stat: clauses=" << clause_num << "\n";
+    out << "%%%mzn-stat: duplicateClauses=" << duplicate_clause_num << "\n";
+    out << "%%%mzn-stat: subsumedClauses=" << subsumed_clause_num << "\n";
+    out << "%%%mzn-stat: dedupRate=" << dedup_rate << "\n";
+    if(!portfolio_winner.empty())
+        out << "%%%mzn-stat: portfolioWinner=\"" << portfolio_winner << "\"\n";
+    out << "%%%mzn-stat-end" << endl;
 }
 
 //Writes the clauses currently present to a SMTLIB file and clears 
 //the cnf_clauses vector
 void Encoder::write_clauses_to_smtlib_file(CNF& cnf_clauses) {
-    ofstream file("helper2.smt2", ios::app); 
+    ofstream file(scratch_path("helper2.smt2"), ios::app); 
 
     string buffer;
     buffer.reserve(1 << 20); 
@@ -331,12 +1039,6 @@ void Encoder::write_clauses_to_smtlib_file(CNF& cnf_clauses) {
                 lit_num = next_dimacs_num++;
                 literal_to_num[key] = lit_num;
 
-                if (l->type == LiteralType::ORDER ||
-                    l->type == LiteralType::BOOL_VARIABLE ||
-                    l->type == LiteralType::SET_ELEM)
-                    num_to_literal[lit_num] = l;
-
-
                 if(export_proof){
                     if(l->type == LiteralType::ORDER){
 
@@ -1158,7 +1860,7 @@ void Encoder::handle_set_vars(){
         int j = 0;
         auto elems = get_set_elems(*var);
 
-        smt_sat_funs << "(define-fun g_" << *var->name << " () (_ BitVec \n";
+        smt_sat_funs << "(define-fun g_" << *var->name << " () (_ BitVec " << bv_right - bv_left + 1 << ")\n";
 
         if((*elems).size() > 0)
             smt_sat_funs << "(bvor\n";
@@ -1242,7 +1944,7 @@ void Encoder::handle_set_in_constraints(){
     }
 }
 
-void Encoder::write_ones(ofstream& proof_file){
+void Encoder::write_ones(ostream& proof_file){
 
     int bv_diff = bv_right - bv_left + 1;
 
@@ -1254,7 +1956,7 @@ void Encoder::write_ones(ofstream& proof_file){
     proof_file << "))\n";
 }
 
-void Encoder::write_mod_div(ofstream& proof_file){
+void Encoder::write_mod_div(ostream& proof_file){
     proof_file <<
     "(define-fun mzn_mod_f ((x Int) (y Int)) Int\n"
     "    (ite (and (< x 0) (distinct (mod x y) 0))\n"
@@ -1290,7 +1992,7 @@ void Encoder::write_mod_div(ofstream& proof_file){
 
 }
 
-void Encoder::write_lex(ofstream& proof_file){
+void Encoder::write_lex(ostream& proof_file){
 
     int bv_diff = bv_right - bv_left + 1;
     proof_file << "(define-fun leftmost_one ((?x (_ BitVec " << bv_diff << "))) Int\n";
@@ -1344,29 +2046,65 @@ void Encoder::write_lex(ofstream& proof_file){
 
 }
 
+// Writes out what is buffered for the scratch files of the proof, so that
+// they can be read back and appended to the proof files
 void Encoder::flush_buffers(){
-    trivial_encoding_vars.flush();
-    trivial_encoding_constraints.flush();
-    trivial_encoding_domains.flush();
-    connection_formula.flush();
-    sat_smt_funs.flush();
-    smt_sat_funs.flush();
-    left_total.flush();
-    right_total.flush();
-    smt_subspace.flush();
-    sat_subspace.flush();
+    trivial_encoding_vars.write_out();
+    trivial_encoding_constraints.write_out();
+    trivial_encoding_domains.write_out();
+    connection_formula.write_out();
+    sat_smt_funs.write_out();
+    smt_sat_funs.write_out();
+    left_total.write_out();
+    right_total.write_out();
+    smt_subspace.write_out();
+    sat_subspace.write_out();
+    sat_dom.write_out();
+    sat_constraints.write_out();
 
     if(is2step){
-        connection2step.flush();
-        domains2step.flush();
-        constraints2step1.flush();
-        constraints2step2.flush();
-        smt_step1_funs.flush();
-        left_total_step1.flush();
-        smt_subspace_step1.flush();
+        connection2step.write_out();
+        domains2step.write_out();
+        constraints2step1.write_out();
+        constraints2step2.write_out();
+        smt_step1_funs.write_out();
+        left_total_step1.write_out();
+        smt_subspace_step1.write_out();
+    }
+}
+
+// Removes the scratch files of the proof once the proof files are written
+void Encoder::remove_scratch_files() const {
+
+    for(const char* name : {"helper2", "connection_formula", "trivial_encoding_vars", "trivial_encoding_constraints",
+                            "trivial_encoding_domains", "sat_dom", "smt_subspace", "sat_subspace", "left_containing",
+                            "right_containing", "left_total", "right_total", "sat_constraints", "sat_smt_funs",
+                            "smt_sat_funs", "connection2step", "constraints2step1", "constraints2step2", "domains2step",
+                            "left_total_step1", "smt_step1_funs", "smt_subspace_step1", "proof", "proof_step1"}){
+        error_code error;
+        filesystem::remove(scratch_path(string(name) + ".smt2"), error);
     }
 }
 
+// Moves the files of the working directory whose names end with the
+// given suffix into one of its directories
+void Encoder::move_scratch_files(const string& suffix, const string& dir) const {
+
+    filesystem::path work_dir = options.work_dir.empty() ? "." : options.work_dir;
+    filesystem::create_directories(work_dir / dir);
+
+    vector<filesystem::path> files;
+    for(auto& entry : filesystem::directory_iterator(work_dir)){
+        string name = entry.path().filename().string();
+        if(entry.is_regular_file() && name.size() >= suffix.size()
+                && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            files.push_back(entry.path());
+    }
+
+    for(auto& file : files)
+        filesystem::rename(file, work_dir / dir / file.filename());
+}
+
 void Encoder::generate_proof(){
 
     if(is2step){
@@ -1374,9 +2112,8 @@ void Encoder::generate_proof(){
         return;
     }
 
-    system("rm -f proof.smt2");
-    ofstream proof_file = ofstream("proof.smt2", ios::app);
-    flush_buffers();
+    ProofWriter proof_file;
+    proof_file.open(scratch_path("proof.smt2"));
 
     proof_file << "(set-option :produce-models true)\n";
     proof_file << "(set-option :produce-proofs true)\n";
@@ -1408,24 +2145,13 @@ void Encoder::generate_proof(){
     if(needOnes)
         write_ones(proof_file);
 
-    string command =
-        "awk '/BitVec/{$0=$0\"" + std::to_string(bv_diff) + "))\"}1' "
-        "trivial_encoding_vars.smt2 > tmp && mv tmp trivial_encoding_vars.smt2";
-
-    system(command.c_str());
-
-    command =
-        "awk '/define-fun/ { gsub(/BitVec/, \"BitVec " +
-        std::to_string(bv_diff) +
-    ")\") } 1' smt_sat_funs.smt2 > tmp && mv tmp smt_sat_funs.smt2";
-
-
-    system(command.c_str());
+    // The scratch files are complete once the set variables are handled
+    flush_buffers();
 
-    system("cat trivial_encoding_vars.smt2 >> proof.smt2");
+    proof_file.append(trivial_encoding_vars, to_string(bv_diff) + "))");
 
     int num_vars = 0;
-    ifstream formula("formula.cnf");
+    ifstream formula(scratch_path("formula.cnf"));
     string dummy;
     formula >> dummy >> dummy >> num_vars;  
     formula.close();
@@ -1435,8 +2161,8 @@ void Encoder::generate_proof(){
     }
     proof_file << endl;
 
-    ifstream smt_dom_reader = ifstream("trivial_encoding_domains.smt2");
-    if(std::filesystem::file_size("trivial_encoding_domains.smt2") > 0)
+    ifstream smt_dom_reader = ifstream(scratch_path("trivial_encoding_domains.smt2"));
+    if(std::filesystem::file_size(scratch_path("trivial_encoding_domains.smt2")) > 0)
         proof_file << "(define-fun smt_dom" << smt_dom_num++ << " () Bool\n(and\n"; 
     string line;
     bool should_define_fun = false;
@@ -1467,7 +2193,7 @@ void Encoder::generate_proof(){
         proof_file << ")" << endl;
     }
 
-    system("cat trivial_encoding_constraints.smt2 >> proof.smt2");
+    proof_file.append(trivial_encoding_constraints);
 
     proof_file << "(define-fun smt_encode () Bool\n";
     proof_file << "(and\n";
@@ -1477,8 +2203,8 @@ void Encoder::generate_proof(){
     proof_file << ")\n)\n";
 
 
-    ifstream sat_dom_reader = ifstream("sat_dom.smt2");
-    if(std::filesystem::file_size("sat_dom.smt2") > 0)
+    ifstream sat_dom_reader = ifstream(scratch_path("sat_dom.smt2"));
+    if(std::filesystem::file_size(scratch_path("sat_dom.smt2")) > 0)
         proof_file << "(define-fun sat_dom" << sat_dom_num++ << " () Bool\n(and\n"; 
  
     should_define_fun = false;
@@ -1509,22 +2235,30 @@ void Encoder::generate_proof(){
         proof_file << ")" << endl;
     }
 
-    ifstream sat_constraints_file("sat_constraints.smt2");
+    ifstream sat_constraints_file(scratch_path("sat_constraints.smt2"));
     int k = 1;
 
     proof_file << "(define-fun sat_c" << k++ << " () Bool\n";
     proof_file << "(and " << endl;
 
+    // The clauses of each constraint end with ---, and the last one is not
+    // followed by another constraint
+    should_define_fun = false;
     while(getline(sat_constraints_file, line)){
-        if(line == "---"){
-            proof_file << ")\n)" << endl;
-
+        if(should_define_fun){
             proof_file << "(define-fun sat_c" << k++ << " () Bool\n";
             proof_file << "(and " << endl;
+            should_define_fun = false;
+        }
+
+        if(line == "---"){
+            proof_file << ")\n)" << endl;
+            should_define_fun = true;
         } else
             proof_file << line << endl;
     }
-    proof_file << ")\n)" << endl;
+    if(!should_define_fun)
+        proof_file << ")\n)" << endl;
 
     proof_file << "(define-fun sat_encode () Bool\n";
     proof_file << "(and\n";
@@ -1533,9 +2267,9 @@ void Encoder::generate_proof(){
         proof_file << "sat_c" << i << endl;
     proof_file << ")\n)\n";
 
-    ifstream smt_sat_rel_reader = ifstream("connection_formula.smt2");
+    ifstream smt_sat_rel_reader = ifstream(scratch_path("connection_formula.smt2"));
 
-    if(std::filesystem::file_size("connection_formula.smt2") > 0)
+    if(std::filesystem::file_size(scratch_path("connection_formula.smt2")) > 0)
         proof_file << "(define-fun smt_sat_rel" << smt_sat_rel_num++ << " () Bool\n(and\n"; 
 
     int i = 0, granulation = 50;
@@ -1606,8 +2340,8 @@ void Encoder::generate_proof(){
         proof_file << ")\n";
     proof_file << ")\n";
 
-    ifstream smt_subspace_reader = ifstream("smt_subspace.smt2");
-    if(std::filesystem::file_size("smt_subspace.smt2") > 0)
+    ifstream smt_subspace_reader = ifstream(scratch_path("smt_subspace.smt2"));
+    if(std::filesystem::file_size(scratch_path("smt_subspace.smt2")) > 0)
         proof_file << "(define-fun smt_subspace" << smt_subspace_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -1638,8 +2372,8 @@ void Encoder::generate_proof(){
         proof_file << ")\n";
     }
 
-    ifstream sat_subspace_reader = ifstream("sat_subspace.smt2");
-    if(std::filesystem::file_size("sat_subspace.smt2") > 0)
+    ifstream sat_subspace_reader = ifstream(scratch_path("sat_subspace.smt2"));
+    if(std::filesystem::file_size(scratch_path("sat_subspace.smt2")) > 0)
         proof_file << "(define-fun sat_subspace" << sat_subspace_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -1670,14 +2404,14 @@ void Encoder::generate_proof(){
         proof_file << ")" << endl;
     }
 
-    system("cat sat_smt_funs.smt2 >> proof.smt2");
+    proof_file.append(sat_smt_funs);
 
-    system("cat smt_sat_funs.smt2 >> proof.smt2");
+    proof_file.append(smt_sat_funs);
 
-    system("rm -f smt_containing_proof.smt2");
-    ofstream smt_containing_proof = ofstream("smt_containing_proof.smt2", ios::app);
+    ProofWriter smt_containing_proof;
+    smt_containing_proof.open(scratch_path("smt_containing_proof.smt2"));
 
-    system("cat proof.smt2 >> smt_containing_proof.smt2");
+    smt_containing_proof.append(proof_file);
 
     for(int i = 1; i < smt_subspace_num; i++){
         smt_containing_proof << "(push)\n";
@@ -1708,10 +2442,10 @@ void Encoder::generate_proof(){
 
     smt_containing_proof.close();
 
-    system("rm -f sat_containing_proof.smt2");
-    ofstream sat_containing_proof = ofstream("sat_containing_proof.smt2", ios::app);
+    ProofWriter sat_containing_proof;
+    sat_containing_proof.open(scratch_path("sat_containing_proof.smt2"));
 
-    system("cat proof.smt2 >> sat_containing_proof.smt2");
+    sat_containing_proof.append(proof_file);
 
     for(int i = 1; i < sat_subspace_num; i++){
         sat_containing_proof << "(push)\n";
@@ -1742,10 +2476,10 @@ void Encoder::generate_proof(){
 
     sat_containing_proof.close();
 
-    system("rm -f left_total_proof.smt2");
-    ofstream left_total_proof = ofstream("left_total_proof.smt2", ios::app);
+    ProofWriter left_total_proof;
+    left_total_proof.open(scratch_path("left_total_proof.smt2"));
 
-    system("cat proof.smt2 >> left_total_proof.smt2");
+    left_total_proof.append(proof_file);
 
     for(int i = 1; i < smt_sat_rel_num; i++){
         left_total_proof << "(push)\n";
@@ -1761,7 +2495,7 @@ void Encoder::generate_proof(){
             } 
         }        
 
-        ifstream left_total_file("left_total.smt2");
+        ifstream left_total_file(scratch_path("left_total.smt2"));
         string line;
         while(getline(left_total_file, line)){
             stringstream ss(line);
@@ -1805,7 +2539,7 @@ void Encoder::generate_proof(){
             } 
         }        
 
-        ifstream left_total_file("left_total.smt2");
+        ifstream left_total_file(scratch_path("left_total.smt2"));
         string line;
         while(getline(left_total_file, line)){
             stringstream ss(line);
@@ -1831,10 +2565,10 @@ void Encoder::generate_proof(){
 
     left_total_proof.close();
 
-    system("rm -f right_total_proof.smt2");
-    ofstream right_total_proof = ofstream("right_total_proof.smt2", ios::app);
+    ProofWriter right_total_proof;
+    right_total_proof.open(scratch_path("right_total_proof.smt2"));
 
-    system("cat proof.smt2 >> right_total_proof.smt2");
+    right_total_proof.append(proof_file);
 
     for(int i = 1; i < smt_sat_rel_num; i++){
         right_total_proof << "(push)\n";
@@ -1850,7 +2584,7 @@ void Encoder::generate_proof(){
             } 
         }        
 
-        ifstream right_total_file("right_total.smt2");
+        ifstream right_total_file(scratch_path("right_total.smt2"));
         string line;
         while(getline(right_total_file, line)){
             stringstream ss(line);
@@ -1894,7 +2628,7 @@ void Encoder::generate_proof(){
             } 
         }        
 
-        ifstream right_total_file("right_total.smt2");
+        ifstream right_total_file(scratch_path("right_total.smt2"));
         string line;
         while(getline(right_total_file, line)){
             stringstream ss(line);
@@ -1920,10 +2654,10 @@ void Encoder::generate_proof(){
 
     right_total_proof.close();
 
-    system("rm -f soundness_proof.smt2");
-    ofstream soundness_proof = ofstream("soundness_proof.smt2", ios::app);
+    ProofWriter soundness_proof;
+    soundness_proof.open(scratch_path("soundness_proof.smt2"));
 
-    system("cat proof.smt2 >> soundness_proof.smt2");
+    soundness_proof.append(proof_file);
 
     for(int i = 1; i < sat_dom_num; i++){
         soundness_proof << "(push)\n";
@@ -2020,23 +2754,17 @@ void Encoder::generate_proof(){
     soundness_proof.close();
 
 
-    system("rm -f helper2.smt2 connection_formula.smt2 trivial*.smt2 sat_dom.smt2 *subspace.smt2");
-    system("rm -f left_containing.smt2 right_containing.smt2 left_total.smt2 right_total.smt2 sat_constraints.smt2");
-    system("rm -f sat_smt_funs.smt2 smt_sat_funs.smt2");
-    system("rm -f connection2step.smt2 constraints2step1.smt2 constraints2step2.smt2 domains2step.smt2");
-    system("rm -f left_total_step1.smt2 smt_step1_funs.smt2 smt_subspace_step1.smt2");
-
-    system("rm proof.smt2");
-    system("mkdir -p proofs");
-    system("mv *.smt2 proofs");
+    remove_scratch_files();
+    move_scratch_files(".smt2", "proofs");
+    if(options.split_proof)
+        split_proof_files("proofs");
 
     proof_file.close();
 }
 
 void Encoder::generate_proof2step(){
-    system("rm -f proof_step1.smt2");
-    ofstream proof_file = ofstream("proof_step1.smt2", ios::app);
-    flush_buffers();
+    ProofWriter proof_file;
+    proof_file.open(scratch_path("proof_step1.smt2"));
 
     proof_file << "(set-option :produce-models true)\n";
     proof_file << "(set-option :produce-proofs true)\n";
@@ -2071,24 +2799,13 @@ void Encoder::generate_proof2step(){
 
     write_sat_dom_clauses(sat_dom_clauses2step);
 
-    string command =
-        "awk '/BitVec/{$0=$0\"" + std::to_string(bv_diff) + "))\"}1' "
-        "trivial_encoding_vars.smt2 > tmp && mv tmp trivial_encoding_vars.smt2";
-
-    system(command.c_str());
-
-    command =
-        "awk '/define-fun/ { gsub(/BitVec/, \"BitVec " +
-        std::to_string(bv_diff) +
-    ")\") } 1' smt_sat_funs.smt2 > tmp && mv tmp smt_sat_funs.smt2";
-
-
-    system(command.c_str());
+    // The scratch files are complete once the set variables are handled
+    flush_buffers();
 
-    system("cat trivial_encoding_vars.smt2 >> proof_step1.smt2");
+    proof_file.append(trivial_encoding_vars, to_string(bv_diff) + "))");
 
     proof_file << "\n(define-fun smt_dom_step1 () Bool\n(and\n";
-    ifstream smt_dom_step1_reader = ifstream("trivial_encoding_domains.smt2");
+    ifstream smt_dom_step1_reader = ifstream(scratch_path("trivial_encoding_domains.smt2"));
     string line;   
     while(getline(smt_dom_step1_reader, line)){
 
@@ -2097,8 +2814,8 @@ void Encoder::generate_proof2step(){
     }
     proof_file << ")\n)\n" << endl;
 
-    system("cat trivial_encoding_constraints.smt2 >> proof_step1.smt2");
-    system("cat constraints2step1.smt2 >> proof_step1.smt2");
+    proof_file.append(trivial_encoding_constraints);
+    proof_file.append(constraints2step1);
     
 
     proof_file << "(define-fun smt_encode_step1 () Bool\n";
@@ -2113,14 +2830,14 @@ void Encoder::generate_proof2step(){
     proof_file << ")\n)\n";
 
     proof_file << "(define-fun smt_dom () Bool\n(and\n";
-    ifstream smt_dom_step2_reader = ifstream("trivial_encoding_domains.smt2");  
+    ifstream smt_dom_step2_reader = ifstream(scratch_path("trivial_encoding_domains.smt2"));  
     while(getline(smt_dom_step2_reader, line)){
 
         if(line != "---")
             proof_file << line << endl;
     }
 
-    smt_dom_step2_reader = ifstream("domains2step.smt2");  
+    smt_dom_step2_reader = ifstream(scratch_path("domains2step.smt2"));  
     while(getline(smt_dom_step2_reader, line)){
 
         if(line != "---")
@@ -2128,7 +2845,7 @@ void Encoder::generate_proof2step(){
     }
     proof_file << ")\n)" << endl;
 
-    system("cat constraints2step2.smt2 >> proof_step1.smt2");
+    proof_file.append(constraints2step2);
 
     proof_file << "(define-fun smt_encode () Bool\n";
     proof_file << "(and\n";
@@ -2143,8 +2860,8 @@ void Encoder::generate_proof2step(){
     
     bool should_define_fun = false;
 
-    ifstream smt_subspace_reader = ifstream("smt_subspace_step1.smt2");
-    if(std::filesystem::file_size("smt_subspace_step1.smt2") > 0)
+    ifstream smt_subspace_reader = ifstream(scratch_path("smt_subspace_step1.smt2"));
+    if(std::filesystem::file_size(scratch_path("smt_subspace_step1.smt2")) > 0)
         proof_file << "(define-fun smt_subspace_step1_" << smt_subspace_step1_num++ <<" () Bool\n(and\n"; 
 
     
@@ -2179,8 +2896,8 @@ void Encoder::generate_proof2step(){
         proof_file << ")\n";
     }
 
-    smt_subspace_reader = ifstream("smt_subspace_step1.smt2");
-    if(std::filesystem::file_size("smt_subspace_step1.smt2") > 0)
+    smt_subspace_reader = ifstream(scratch_path("smt_subspace_step1.smt2"));
+    if(std::filesystem::file_size(scratch_path("smt_subspace_step1.smt2")) > 0)
         proof_file << "(define-fun smt_subspace" << smt_subspace_step2_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -2200,8 +2917,8 @@ void Encoder::generate_proof2step(){
             proof_file << line << endl;
     }
 
-    ifstream connection2step_reader = ifstream("connection2step.smt2");
-    if((std::filesystem::file_size("connection2step.smt2") > 0 && should_define_fun) || std::filesystem::file_size("smt_subspace_step1.smt2") == 0)
+    ifstream connection2step_reader = ifstream(scratch_path("connection2step.smt2"));
+    if((std::filesystem::file_size(scratch_path("connection2step.smt2")) > 0 && should_define_fun) || std::filesystem::file_size(scratch_path("smt_subspace_step1.smt2")) == 0)
         proof_file << "(define-fun smt_subspace" << smt_subspace_step2_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;    
@@ -2228,14 +2945,13 @@ void Encoder::generate_proof2step(){
         proof_file << ")\n";
     proof_file << ")" << endl;
     
-    system("cat smt_step1_funs.smt2 >> proof_step1.smt2");
+    proof_file.append(smt_step1_funs);
 
-    system("mkdir -p proofs_step1");
 
-    system("rm -f smt_containing_step1_proof_step1.smt2");
-    ofstream smt_containing_step1_proof_step1 = ofstream("smt_containing_step1_proof_step1.smt2", ios::app);
+    ProofWriter smt_containing_step1_proof_step1;
+    smt_containing_step1_proof_step1.open(scratch_path("smt_containing_step1_proof_step1.smt2"));
 
-    system("cat proof_step1.smt2 >> smt_containing_step1_proof_step1.smt2");
+    smt_containing_step1_proof_step1.append(proof_file);
 
     for(int i = 1; i < smt_subspace_step1_num; i++){
         smt_containing_step1_proof_step1 << "(push)\n";
@@ -2264,10 +2980,10 @@ void Encoder::generate_proof2step(){
 
     smt_containing_step1_proof_step1.close();
 
-    system("rm -f smt_containing_step2_proof_step1.smt2");
-    ofstream smt_containing_step2_proof_step1 = ofstream("smt_containing_step2_proof_step1.smt2", ios::app);
+    ProofWriter smt_containing_step2_proof_step1;
+    smt_containing_step2_proof_step1.open(scratch_path("smt_containing_step2_proof_step1.smt2"));
 
-    system("cat proof_step1.smt2 >> smt_containing_step2_proof_step1.smt2");
+    smt_containing_step2_proof_step1.append(proof_file);
 
 
     for(int i = 1; i < smt_subspace_step2_num; i++){
@@ -2296,16 +3012,16 @@ void Encoder::generate_proof2step(){
 
     }
 
-    system("rm -f left_total_proof_step1.smt2");
-    ofstream left_total_proof_step1 = ofstream("left_total_proof_step1.smt2", ios::app);
+    ProofWriter left_total_proof_step1;
+    left_total_proof_step1.open(scratch_path("left_total_proof_step1.smt2"));
 
-    system("cat proof_step1.smt2 >> left_total_proof_step1.smt2");
+    left_total_proof_step1.append(proof_file);
 
     left_total_proof_step1 << "(push)\n";
     left_total_proof_step1 << "(echo \"Check left-total step 1 R\")\n";
     left_total_proof_step1 << "(assert (and\n";
     left_total_proof_step1 << "smt_subspace_step1" << endl;
-    system("cat left_total_step1.smt2 >> left_total_proof_step1.smt2");
+    left_total_proof_step1.append(left_total_step1);
     left_total_proof_step1 << "(not smt_step1_rel )\n";
     left_total_proof_step1 << ")\n)\n";
     left_total_proof_step1 << "(check-sat)\n";
@@ -2334,7 +3050,7 @@ void Encoder::generate_proof2step(){
             } 
         }        
 
-        ifstream left_total_file("left_total_step1.smt2");
+        ifstream left_total_file(scratch_path("left_total_step1.smt2"));
         string line;
         while(getline(left_total_file, line)){
             stringstream ss(line);
@@ -2362,10 +3078,10 @@ void Encoder::generate_proof2step(){
 
     left_total_proof_step1.close();
 
-    system("rm -f right_total_proof_step1.smt2");
-    ofstream right_total_proof_step1 = ofstream("right_total_proof_step1.smt2", ios::app);
+    ProofWriter right_total_proof_step1;
+    right_total_proof_step1.open(scratch_path("right_total_proof_step1.smt2"));
 
-    system("cat proof_step1.smt2 >> right_total_proof_step1.smt2");
+    right_total_proof_step1.append(proof_file);
 
     right_total_proof_step1 << "(push)\n";
     right_total_proof_step1 << "(echo \"Check right-total step 1 R\")\n";
@@ -2414,10 +3130,10 @@ void Encoder::generate_proof2step(){
 
     right_total_proof_step1.close();
 
-    system("rm -f soundness_proof_step1.smt2");
-    ofstream soundness_proof_step1 = ofstream("soundness_proof_step1.smt2", ios::app);
+    ProofWriter soundness_proof_step1;
+    soundness_proof_step1.open(scratch_path("soundness_proof_step1.smt2"));
 
-    system("cat proof_step1.smt2 >> soundness_proof_step1.smt2");    
+    soundness_proof_step1.append(proof_file);
 
     soundness_proof_step1 << "(push)\n";
     soundness_proof_step1 << "(echo \"Check soundness dom step 1\")\n";
@@ -2472,9 +3188,7 @@ void Encoder::generate_proof2step(){
 
     soundness_proof_step1.close();
 
-    proof_file.close();
-    system("rm -f proof.smt2");
-    proof_file = ofstream("proof.smt2", ios::app);
+    proof_file.open(scratch_path("proof.smt2"));
 
     proof_file << "(set-option :produce-models true)\n";
     proof_file << "(set-option :produce-proofs true)\n";
@@ -2498,10 +3212,10 @@ void Encoder::generate_proof2step(){
     if(needLex)
         write_lex(proof_file);
 
-    system("cat trivial_encoding_vars.smt2 >> proof.smt2");
+    proof_file.append(trivial_encoding_vars, to_string(bv_diff) + "))");
 
     int num_vars = 0;
-    ifstream formula("formula.cnf");
+    ifstream formula(scratch_path("formula.cnf"));
     string dummy;
     formula >> dummy >> dummy >> num_vars;  
     formula.close();
@@ -2511,8 +3225,8 @@ void Encoder::generate_proof2step(){
     }
     proof_file << endl;
 
-    ifstream smt_dom_reader = ifstream("trivial_encoding_domains.smt2");
-    if(std::filesystem::file_size("trivial_encoding_domains.smt2") > 0)
+    ifstream smt_dom_reader = ifstream(scratch_path("trivial_encoding_domains.smt2"));
+    if(std::filesystem::file_size(scratch_path("trivial_encoding_domains.smt2")) > 0)
         proof_file << "(define-fun smt_dom" << smt_dom_num++ << " () Bool\n(and\n"; 
     
     should_define_fun = false;
@@ -2533,8 +3247,8 @@ void Encoder::generate_proof2step(){
     smt_dom_vars.pop_back();
     smt_dom_vars.insert(smt_dom_vars.end(), smt_dom_vars2step.begin(), smt_dom_vars2step.end());
 
-    smt_dom_reader = ifstream("domains2step.smt2");
-    if(std::filesystem::file_size("domains2step.smt2") > 0)
+    smt_dom_reader = ifstream(scratch_path("domains2step.smt2"));
+    if(std::filesystem::file_size(scratch_path("domains2step.smt2")) > 0)
         proof_file << "(define-fun smt_dom" << smt_dom_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -2565,8 +3279,8 @@ void Encoder::generate_proof2step(){
         proof_file << ")" << endl;
     }
 
-    system("cat trivial_encoding_constraints.smt2 >> proof.smt2");
-    system("cat constraints2step2.smt2 >> proof.smt2");
+    proof_file.append(trivial_encoding_constraints);
+    proof_file.append(constraints2step2);
 
 
     proof_file << "(define-fun smt_encode () Bool\n";
@@ -2576,8 +3290,8 @@ void Encoder::generate_proof2step(){
         proof_file << "smt_c" << i << endl;
     proof_file << ")\n)\n";
 
-    ifstream sat_dom_reader = ifstream("sat_dom.smt2");
-    if(std::filesystem::file_size("sat_dom.smt2") > 0)
+    ifstream sat_dom_reader = ifstream(scratch_path("sat_dom.smt2"));
+    if(std::filesystem::file_size(scratch_path("sat_dom.smt2")) > 0)
         proof_file << "(define-fun sat_dom" << sat_dom_num++ << " () Bool\n(and\n"; 
  
     should_define_fun = false;
@@ -2608,22 +3322,30 @@ void Encoder::generate_proof2step(){
         proof_file << ")" << endl;
     }
 
-    ifstream sat_constraints_file("sat_constraints.smt2");
+    ifstream sat_constraints_file(scratch_path("sat_constraints.smt2"));
     int k = 1;
 
     proof_file << "(define-fun sat_c" << k++ << " () Bool\n";
     proof_file << "(and " << endl;
-    
-    while(getline(sat_constraints_file, line)){
-        if(line == "---"){
-            proof_file << ")\n)" << endl;
 
+    // The clauses of each constraint end with ---, and the last one is not
+    // followed by another constraint
+    should_define_fun = false;
+    while(getline(sat_constraints_file, line)){
+        if(should_define_fun){
             proof_file << "(define-fun sat_c" << k++ << " () Bool\n";
             proof_file << "(and " << endl;
+            should_define_fun = false;
+        }
+
+        if(line == "---"){
+            proof_file << ")\n)" << endl;
+            should_define_fun = true;
         } else
             proof_file << line << endl;
     }
-    proof_file << ")\n)" << endl;
+    if(!should_define_fun)
+        proof_file << ")\n)" << endl;
 
     proof_file << "(define-fun sat_encode () Bool\n";
     proof_file << "(and\n";
@@ -2632,9 +3354,9 @@ void Encoder::generate_proof2step(){
         proof_file << "sat_c" << i << endl;
     proof_file << ")\n)\n";
 
-    ifstream smt_sat_rel_reader = ifstream("connection_formula.smt2");
+    ifstream smt_sat_rel_reader = ifstream(scratch_path("connection_formula.smt2"));
 
-    if(std::filesystem::file_size("connection_formula.smt2") > 0)
+    if(std::filesystem::file_size(scratch_path("connection_formula.smt2")) > 0)
         proof_file << "(define-fun smt_sat_rel" << smt_sat_rel_num++ << " () Bool\n(and\n"; 
 
     int i = 0, granulation = 50;
@@ -2706,8 +3428,8 @@ void Encoder::generate_proof2step(){
     proof_file << ")\n";
 
 
-    smt_subspace_reader = ifstream("smt_subspace.smt2");
-    if(std::filesystem::file_size("smt_subspace.smt2") > 0)
+    smt_subspace_reader = ifstream(scratch_path("smt_subspace.smt2"));
+    if(std::filesystem::file_size(scratch_path("smt_subspace.smt2")) > 0)
         proof_file << "(define-fun smt_subspace" << smt_subspace_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -2734,8 +3456,8 @@ void Encoder::generate_proof2step(){
         proof_file << ")\n";
     proof_file << ")\n";
 
-    ifstream sat_subspace_reader = ifstream("sat_subspace.smt2");
-    if(std::filesystem::file_size("sat_subspace.smt2") > 0)
+    ifstream sat_subspace_reader = ifstream(scratch_path("sat_subspace.smt2"));
+    if(std::filesystem::file_size(scratch_path("sat_subspace.smt2")) > 0)
         proof_file << "(define-fun sat_subspace" << sat_subspace_num++ << " () Bool\n(and\n"; 
 
     should_define_fun = false;
@@ -2762,16 +3484,15 @@ void Encoder::generate_proof2step(){
         proof_file << ")\n";
     proof_file << ")" << endl;
 
-    system("cat sat_smt_funs.smt2 >> proof.smt2");
+    proof_file.append(sat_smt_funs);
 
-    system("cat smt_sat_funs.smt2 >> proof.smt2");
+    proof_file.append(smt_sat_funs);
 
-    system("mkdir -p proofs");
 
-    system("rm -f smt_containing_proof.smt2");
-    ofstream smt_containing_proof = ofstream("smt_containing_proof.smt2", ios::app);
+    ProofWriter smt_containing_proof;
+    smt_containing_proof.open(scratch_path("smt_containing_proof.smt2"));
 
-    system("cat proof.smt2 >> smt_containing_proof.smt2");    
+    smt_containing_proof.append(proof_file);
 
 
     for(int i = 1; i < smt_subspace_num; i++){
@@ -2805,10 +3526,10 @@ void Encoder::generate_proof2step(){
 
     smt_containing_proof.close();
 
-    system("rm -f sat_containing_proof.smt2");
-    ofstream sat_containing_proof = ofstream("sat_containing_proof.smt2", ios::app);
+    ProofWriter sat_containing_proof;
+    sat_containing_proof.open(scratch_path("sat_containing_proof.smt2"));
 
-    system("cat proof.smt2 >> sat_containing_proof.smt2");    
+    sat_containing_proof.append(proof_file);
 
     for(int i = 1; i < sat_subspace_num; i++){
         sat_containing_proof << "(push)\n";
@@ -2839,10 +3560,10 @@ void Encoder::generate_proof2step(){
 
     sat_containing_proof.close();
 
-    system("rm -f left_total_proof.smt2");
-    ofstream left_total_proof = ofstream("left_total_proof.smt2", ios::app);
+    ProofWriter left_total_proof;
+    left_total_proof.open(scratch_path("left_total_proof.smt2"));
 
-    system("cat proof.smt2 >> left_total_proof.smt2");    
+    left_total_proof.append(proof_file);
 
     for(int i = 1; i < smt_sat_rel_num; i++){
         left_total_proof << "(push)\n";
@@ -2858,7 +3579,7 @@ void Encoder::generate_proof2step(){
             } 
         }        
 
-        ifstream left_total_file("left_total.smt2");
+        ifstream left_total_file(scratch_path("left_total.smt2"));
         string line;
         while(getline(left_total_file, line)){
             stringstream ss(line);
@@ -2902,7 +3623,7 @@ void Encoder::generate_proof2step(){
             } 
         }        
 
-        ifstream left_total_file("left_total.smt2");
+        ifstream left_total_file(scratch_path("left_total.smt2"));
         string line;
         while(getline(left_total_file, line)){
             stringstream ss(line);
@@ -2928,10 +3649,10 @@ void Encoder::generate_proof2step(){
 
     left_total_proof.close();
 
-    system("rm -f right_total_proof.smt2");
-    ofstream right_total_proof = ofstream("right_total_proof.smt2", ios::app);
+    ProofWriter right_total_proof;
+    right_total_proof.open(scratch_path("right_total_proof.smt2"));
 
-    system("cat proof.smt2 >> right_total_proof.smt2");    
+    right_total_proof.append(proof_file);
 
     right_total.flush();
 
@@ -2949,7 +3670,7 @@ void Encoder::generate_proof2step(){
             } 
         }        
 
-        ifstream right_total_file("right_total.smt2");
+        ifstream right_total_file(scratch_path("right_total.smt2"));
         string line;
         while(getline(right_total_file, line)){
             stringstream ss(line);
@@ -2993,7 +3714,7 @@ void Encoder::generate_proof2step(){
             } 
         }        
 
-        ifstream right_total_file("right_total.smt2");
+        ifstream right_total_file(scratch_path("right_total.smt2"));
         string line;
         while(getline(right_total_file, line)){
             stringstream ss(line);
@@ -3018,10 +3739,10 @@ void Encoder::generate_proof2step(){
     }    
     right_total_proof.close();
 
-    system("rm -f soundness_proof.smt2");
-    ofstream soundness_proof = ofstream("soundness_proof.smt2", ios::app);
+    ProofWriter soundness_proof;
+    soundness_proof.open(scratch_path("soundness_proof.smt2"));
 
-    system("cat proof.smt2 >> soundness_proof.smt2");     
+    soundness_proof.append(proof_file);
 
     for(int i = 1; i < sat_dom_num; i++){
         soundness_proof << "(push)\n";
@@ -3117,17 +3838,13 @@ void Encoder::generate_proof2step(){
 
     soundness_proof.close();
 
-    system("rm -f helper2.smt2 connection_formula.smt2 trivial*.smt2 sat_dom.smt2 *subspace.smt2");
-    system("rm -f left_containing.smt2 right_containing.smt2 left_total.smt2 right_total.smt2 sat_constraints.smt2");
-    system("rm -f sat_smt_funs.smt2 smt_sat_funs.smt2");
-    system("rm -f connection2step.smt2 constraints2step1.smt2 constraints2step2.smt2 domains2step.smt2 smt_step1_funs.smt2");
-    system("rm -f left_total_step1.smt2 smt_step1_funs.smt2 smt_subspace_step1.smt2");
-
-    system("rm proof.smt2 proof_step1.smt2");
-    system("mkdir -p proofs");
-    system("mkdir -p proofs_step1");
-    system("mv *_step1.smt2 proofs_step1");
-    system("mv *.smt2 proofs");
+    remove_scratch_files();
+    move_scratch_files("_step1.smt2", "proofs_step1");
+    move_scratch_files(".smt2", "proofs");
+    if(options.split_proof){
+        split_proof_files("proofs_step1");
+        split_proof_files("proofs");
+    }
     
 
     proof_file.close();
@@ -3135,211 +3852,1551 @@ void Encoder::generate_proof2step(){
 
 // Runs the specified solver by executing a system call.
 // The input in the appropriate format should be in the inputFile, and the output is
-// written to the outputFile
+// written to the outputFile. With the pipe_solver option the solver is only started
+// here, and it reads the clauses from a pipe while they are being encoded. An SMT
+// solver is started in interactive mode and given formula.smt2 over a pipe, and
+// its answers are read back by read_solver_output
 void Encoder::run_solver(const string& outputFile) {
 
+    if(options.pipe_solver){
+        start_solver_process();
+        return;
+    }
+
+    if(!options.portfolio.empty()){
+        if(!unsat)
+            run_portfolio();
+        return;
+    }
+
+    long long left = time_left();
+    if(file_type == SMTLIB && (solver_type == Z3 || solver_type == CVC5)){
+        start_smt_solver();
+        if(left >= 0)
+            write_to_solver((solver_type == Z3 ? "(set-option :timeout " : "(set-option :tlimit-per ")
+                            + to_string(max(left, 1LL)) + ")\n");
+        send_file_to_solver(scratch_path("formula.smt2"));
+        return;
+    }
+
+    // The output of an earlier run must not be taken for the answer of a
+    // solver that is stopped at the time limit before it writes its own
+    filesystem::remove(scratch_path(outputFile));
+    if(left == 0)
+        return;
+
+    // minisat and glucose have no limit on the number of conflicts
+    string limit = to_string(options.conflict_limit);
+    string timeout = left > 0 ? "timeout " + to_string(left / 1000) + "." + to_string(1000 + left % 1000).substr(1) + " " : "";
     string command = "";
     if(solver_type == MINISAT && file_type == DIMACS)
-        command = "minisat formula.cnf " + outputFile + "> /dev/null 2>&1";
+        command = timeout + "minisat formula.cnf " + outputFile + "> /dev/null 2>&1";
     else if(solver_type == CADICAL && file_type == DIMACS)
-        command = "cadical -q formula.cnf | cut -c2- > " + outputFile;
+        command = timeout + "cadical -q " + (options.conflict_limit > 0 ? "-c " + limit + " " : "")
+                + "formula.cnf | cut -c2- > " + outputFile;
+    else if(solver_type == CRYPTOMINISAT && file_type == DIMACS)
+        command = timeout + "cryptominisat5 --verb 0 " + (options.conflict_limit > 0 ? "--maxconfl " + limit + " " : "")
+                + "formula.cnf | cut -c2- > " + outputFile;
     else if(solver_type == GLUCOSE && file_type == DIMACS)
-        command = "../scripts/glucose-wrapper formula.cnf " + outputFile + "> /dev/null 2>&1";
-    else if(solver_type == Z3 && file_type == SMTLIB)
-        command = "z3 formula.smt2 > " + outputFile;
-    else if(solver_type == CVC5 && file_type == SMTLIB)
-        command = "cvc5 --produce-models -q formula.smt2 > " + outputFile;
+        command = timeout + std::filesystem::absolute("../scripts/glucose-wrapper").string() + " formula.cnf " + outputFile + "> /dev/null 2>&1";
     else
         cerr << "Unsupported combination of solver and file type\n";
     
-    system(command.c_str());
+    run_in_work_dir(command);
 }
 
-// Reads the solver output, converts it to a human readable format
-// and writes the output to cout
-void Encoder::read_solver_output(const string& outputFile) {
+// Returns the command line of a DIMACS solver reading the given file, or
+// its standard input if the file is empty. The model is written to the
+// standard output. A non-negative seed and a positive conflict limit are
+// passed on to the solver, if it has such an option
+vector<string> solver_command(SolverType solver, int seed, const string& input, long long conflict_limit){
+
+    vector<string> args;
+    if(solver == MINISAT || solver == GLUCOSE){
+        args = {solver == MINISAT ? "minisat" : "glucose", "-verb=0",
+                input.empty() ? "/dev/stdin" : input, "/dev/stdout"};
+        // The random seed of minisat and glucose has to be positive
+        if(seed >= 0)
+            args.push_back("-rnd-seed=" + to_string(seed + 1));
+    } else if(solver == CADICAL){
+        args = {"cadical", "-q", input.empty() ? "-f" : input};
+        if(seed >= 0)
+            args.push_back("--seed=" + to_string(seed));
+        if(conflict_limit > 0)
+            args.insert(args.end(), {"-c", to_string(conflict_limit)});
+    } else if(solver == CRYPTOMINISAT){
+        args = {"cryptominisat5", "--verb", "0"};
+        if(seed >= 0)
+            args.insert(args.end(), {"--random", to_string(seed)});
+        if(conflict_limit > 0)
+            args.insert(args.end(), {"--maxconfl", to_string(conflict_limit)});
+        if(!input.empty())
+            args.push_back(input);
+    }
+
+    return args;
+}
 
-    if(unsat){
-        cout << "UNSAT" << endl;
-        return;
-    }
+// Returns the command line of an SMT solver reading SMT-LIB commands from
+// its standard input and answering each of them on its standard output
+vector<string> smt_solver_command(SolverType solver){
 
-    ifstream output(outputFile);
-    if (!output.is_open()) {
-        cerr << "Cannot open file\n";
-        return;
-    }
+    if(solver == Z3)
+        return {"z3", "-in", "-smt2"};
+    return {"cvc5", "--produce-models", "--incremental", "-q", "--lang=smt2"};
+}
 
-    string sat;
-    output >> sat;
-    if(sat.find("UNSAT") != sat.npos || sat.find("unsat") != sat.npos){
-        cout << "UNSAT" << endl;
-        return;
-    }
+// Returns the name of a portfolio configuration as given on the command line
+string solver_config_name(const pair<SolverType, int>& config){
+    static const char* names[] = {"minisat", "cadical", "glucose", "z3", "cvc5", "cryptominisat"};
+    string name = names[config.first];
+    if(config.second >= 0)
+        name += ":" + to_string(config.second);
+    return name;
+}
 
-    cout << "SAT\n";
+// Spawns a process with its standard output connected to a pipe, and its
+// standard input too if in_fd is given. Returns the process id, or -1 if
+// the process could not be started
+pid_t spawn_process(vector<string> args, int* in_fd, int* out_fd){
+
+    // The pipes are created close-on-exec, so that a process spawned by
+    // another thread in the meantime does not inherit them
+    int in_fds[2] = {-1, -1}, out_fds[2];
+    if(in_fd != nullptr && pipe2(in_fds, O_CLOEXEC) != 0)
+        return -1;
+    if(pipe2(out_fds, O_CLOEXEC) != 0){
+        if(in_fd != nullptr){
+            close(in_fds[0]);
+            close(in_fds[1]);
+        }
+        return -1;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if(in_fd != nullptr)
+        posix_spawn_file_actions_adddup2(&actions, in_fds[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out_fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    vector<char*> argv;
+    for(auto& arg : args)
+        argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    // The process gets its own process group, so that stopping it also
+    // stops any processes it started, e.g. when the solver is a script
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+
+    pid_t pid;
+    int error = posix_spawnp(&pid, argv[0], &actions, &attributes, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    if(in_fd != nullptr)
+        close(in_fds[0]);
+    close(out_fds[1]);
+
+    if(error != 0){
+        cerr << "Cannot start " << args[0] << ": " << strerror(error) << "\n";
+        if(in_fd != nullptr)
+            close(in_fds[1]);
+        close(out_fds[0]);
+        return -1;
+    }
+
+    if(in_fd != nullptr)
+        *in_fd = in_fds[1];
+    *out_fd = out_fds[0];
+    return pid;
+}
 
-    if(file_type == SMTLIB){
-        output.close();
+// Checks whether the solver output contains a SAT or UNSAT answer
+bool has_solver_answer(const string& output){
+    stringstream tokens(output);
+    string token;
+    while(tokens >> token)
+        if(token.find("SAT") != token.npos || token.find("sat") != token.npos)
+            return true;
+    return false;
+}
 
-        if(solver_type == CVC5){
-            system("grep define-fun model.out "
-                    "| sed -E 's/.*x([0-9]+).*Bool (true|false).*/\\1 \\2/'"
-                    " | awk '{if($2==\"false\") printf(\"-%s \",$1); else printf(\"%s \",$1);}'"
-                    " > model.tmp && mv model.tmp model.out");
-        } else if(solver_type == Z3){
-            system("awk '/define-fun/{var=$2} /Bool/{getline; val=$1; gsub(/[()]/, \"\", val); "
-                    "if(val==\"false\") printf(\"-%s \", substr(var,2)); else printf(\"%s \", substr(var,2));}' "
-                    "model.out > model.tmp && mv model.tmp model.out");
-        }
-        
-        output.open(outputFile);
+// Starts the solver with its standard input and output connected to pipes.
+// The number of variables and clauses is not known until the encoding is
+// done, so the DIMACS header is a placeholder, and the solvers are run in
+// modes which tolerate a header that does not match the clauses
+void Encoder::start_solver_process() {
+
+    if(file_type != DIMACS || (solver_type != MINISAT && solver_type != CADICAL && solver_type != CRYPTOMINISAT)){
+        cerr << "Unsupported combination of solver and file type for a pipe\n";
+        return;
     }
 
-    int curr_lit_num;
-    while (output >> curr_lit_num) {
+    solver_pid = spawn_process(solver_command(solver_type, -1, "", options.conflict_limit), &solver_in, &solver_out);
+    if(solver_pid < 0)
+        return;
 
-        bool sign = false;
-        if(curr_lit_num < 0){
-            sign = true;
-            curr_lit_num = -curr_lit_num;
-        }
+    // A solver which exits before reading all of the clauses must not stop the encoder
+    signal(SIGPIPE, SIG_IGN);
 
-        if(num_to_literal.find(curr_lit_num) == num_to_literal.end())
-            continue;
+    write_to_solver("p cnf 0 0\n");
+}
 
-        auto l = num_to_literal[curr_lit_num].get();
+// Starts the SMT solver in interactive mode with its standard input and
+// output connected to pipes
+void Encoder::start_smt_solver() {
 
-        if(id_map.find(l->id) == id_map.end())
-            continue;
+    solver_pid = spawn_process(smt_solver_command(solver_type), &solver_in, &solver_out);
+    if(solver_pid < 0)
+        return;
 
-        Variable* curr_var = id_map[l->id];
-        BasicVar* curr_basic_var = get<BasicVar*>(*curr_var);
-        BasicVarType* curr_basic_var_type = curr_basic_var->type;
+    // A solver which exits before reading all of its input must not stop the encoder
+    signal(SIGPIPE, SIG_IGN);
 
-        if(holds_alternative<IntRangeVarType*>(*curr_basic_var_type)){
-            IntRangeVarType* c = get<IntRangeVarType*>(*curr_basic_var_type);
-            int val = l->val;
-            if(!sign){
-                if(c->right > val)
-                    c->right = val;
-            } else {
-                if(c->left < val + 1)
-                    c->left = val + 1;
-            }
+    // cvc5 has no limit on the number of conflicts, so it gets the nearest
+    // one, a limit on its resources for each check
+    if(solver_type == CVC5)
+        write_to_solver("(set-option :produce-unsat-assumptions true)\n");
+    if(options.conflict_limit > 0)
+        write_to_solver((solver_type == Z3 ? "(set-option :smt.max_conflicts " : "(set-option :rlimit-per ")
+                        + to_string(options.conflict_limit) + ")\n");
+}
 
-            if(c->left == c->right){
-                curr_basic_var->value = new BasicExpr(new BasicLiteralExpr(c->left));
+// Sends the contents of a file to the solver's input. The kernel copies
+// the file to the pipe, and the rest is written in chunks if it cannot
+void Encoder::send_file_to_solver(const string& path) {
 
-                id_map.erase(l->id);
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        cerr << "Cannot open file " << path << "\n";
+        return;
+    }
 
-                if(curr_basic_var->is_output)
-                    cout << *curr_basic_var->name << " = " << c->left << ";\n";
-            } 
-        } else if(holds_alternative<IntSetVarType*>(*curr_basic_var_type)){
-            IntSetVarType* c = get<IntSetVarType*>(*curr_basic_var_type);
-            int* left = &(*c->elems)[0];
-            int* right = &(*c->elems)[c->elems->size() - 1];
-
-            int val = l->val;
-            if(!sign){
-                if(*right > val)
-                    *right = val;
+    struct stat st;
+    off_t offset = 0;
+    if(fstat(fd, &st) == 0){
+        while(solver_in >= 0 && offset < st.st_size){
+            ssize_t n = sendfile(solver_in, fd, &offset, st.st_size - offset);
+            if(n < 0 && errno == EINTR)
+                continue;
+            if(n <= 0)
+                break;
+        }
+    }
+
+    char chunk[1 << 16];
+    lseek(fd, offset, SEEK_SET);
+    while(solver_in >= 0){
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        write_to_solver(string(chunk, n));
+    }
+
+    close(fd);
+}
+
+// Reads the next answer of the SMT solver: a symbol such as sat, or a
+// whole expression such as a model. Parentheses inside strings and quoted
+// symbols are not counted. Returns an empty string if the solver closed
+// its output
+string Encoder::read_smt_response() {
+
+    size_t pos = 0, begin = string::npos, end = string::npos;
+    int depth = 0;
+    char quote = 0;
+    char chunk[1 << 16];
+    while(end == string::npos){
+        for(; pos < smt_pending.size(); pos++){
+            char c = smt_pending[pos];
+            if(quote){
+                if(c == quote)
+                    quote = 0;
+                continue;
+            }
+            if(begin == string::npos){
+                if(isspace(static_cast<unsigned char>(c)))
+                    continue;
+                begin = pos;
+            }
+
+            if(c == '"' || c == '|'){
+                quote = c;
+            } else if(c == '('){
+                depth++;
+            } else if(c == ')' && --depth <= 0){
+                end = pos + 1;
+                break;
+            } else if(depth == 0 && isspace(static_cast<unsigned char>(c))){
+                end = pos;
+                break;
+            }
+        }
+        if(end != string::npos)
+            break;
+
+        ssize_t n = solver_out >= 0 ? read(solver_out, chunk, sizeof(chunk)) : 0;
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0){
+            end = smt_pending.size();
+            break;
+        }
+        smt_pending.append(chunk, n);
+    }
+
+    string response = begin == string::npos ? "" : smt_pending.substr(begin, end - begin);
+    smt_pending.erase(0, end);
+    return response;
+}
+
+// Returns the next token of an SMT-LIB text: a parenthesis or a symbol
+string_view next_smt_token(const string& text, size_t& pos){
+
+    while(pos < text.size() && isspace(static_cast<unsigned char>(text[pos])))
+        pos++;
+    if(pos == text.size())
+        return {};
+
+    size_t begin = pos++;
+    if(text[begin] == '(' || text[begin] == ')')
+        return string_view(text).substr(begin, 1);
+
+    if(text[begin] == '|'){
+        while(pos < text.size() && text[pos] != '|')
+            pos++;
+        pos = min(pos + 1, text.size());
+    } else {
+        while(pos < text.size() && !isspace(static_cast<unsigned char>(text[pos]))
+                && text[pos] != '(' && text[pos] != ')')
+            pos++;
+    }
+    return string_view(text).substr(begin, pos - begin);
+}
+
+// Returns the elements of an SMT-LIB list of literals, such as an unsat
+// core, written as x12 or (not x12)
+vector<string> parse_smt_literals(const string& list){
+
+    vector<string> literals;
+    size_t pos = 0;
+    if(next_smt_token(list, pos) != "(")
+        return literals;
+
+    for(string_view token = next_smt_token(list, pos); !token.empty() && token != ")";
+            token = next_smt_token(list, pos)){
+        if(token != "("){
+            literals.emplace_back(token);
+            continue;
+        }
+
+        string_view op = next_smt_token(list, pos);
+        string_view arg = next_smt_token(list, pos);
+        next_smt_token(list, pos);
+        literals.push_back("(" + string(op) + " " + string(arg) + ")");
+    }
+
+    return literals;
+}
+
+// Returns the SMT-LIB form of a DIMACS literal
+string smt_literal(int lit){
+    return lit > 0 ? "x" + to_string(lit) : "(not x" + to_string(-lit) + ")";
+}
+
+// Returns the negation of a literal written as x12 or (not x12)
+string negate_smt_literal(const string& lit){
+    return lit.rfind("(not ", 0) == 0 ? lit.substr(5, lit.size() - 6) : "(not " + lit + ")";
+}
+
+// Gets the bounds of the domain of an int variable. Returns false if the
+// variable is not an int variable
+bool get_int_domain(const BasicVar& var, int& left, int& right){
+
+    if(holds_alternative<IntRangeVarType*>(*var.type)){
+        left = get<IntRangeVarType*>(*var.type)->left;
+        right = get<IntRangeVarType*>(*var.type)->right;
+    } else if(holds_alternative<IntSetVarType*>(*var.type)){
+        left = get<IntSetVarType*>(*var.type)->elems->front();
+        right = get<IntSetVarType*>(*var.type)->elems->back();
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+// Returns the number of milliseconds left of the time limit, counted from
+// the start of the converter, or -1 if there is no time limit
+long long Encoder::time_left() const {
+
+    if(options.time_limit <= 0)
+        return -1;
+
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - options.start_time);
+    return max(0LL, options.time_limit - (long long)elapsed.count());
+}
+
+// Returns the time left in the form taken by poll, -1 for no time limit
+int Encoder::poll_timeout() const {
+
+    long long left = time_left();
+    return left < 0 ? -1 : (int)min(left, (long long)INT_MAX);
+}
+
+// Asks the SMT solver whether the formula is satisfiable under the given
+// assumptions and returns its answer, which is unknown if the time is up
+string Encoder::smt_check(const vector<string>& assumptions) {
+
+    long long left = time_left();
+    if(left == 0)
+        return "unknown";
+
+    string command = "(check-sat)\n";
+    if(!assumptions.empty()){
+        command = "(check-sat-assuming (";
+        for(auto& lit : assumptions)
+            command += lit + " ";
+        command += "))\n";
+    }
+    // Each check gets the time that is left of the whole limit
+    if(left > 0)
+        command = (solver_type == Z3 ? "(set-option :timeout " : "(set-option :tlimit-per ")
+                  + to_string(left) + ")\n" + command;
+
+    write_to_solver(command);
+    return read_smt_response();
+}
+
+// Returns the variable minimized or maximized by the solve item, or
+// nullptr if the problem is a satisfaction problem or the objective is
+// not a variable
+BasicVar* Encoder::get_objective(SolveType& type) const {
+
+    for(auto& item : items){
+        if(!holds_alternative<Solve*>(item))
+            continue;
+
+        auto solve = get<Solve*>(item);
+        type = solve->type;
+        if(solve->type == ORDINARY || !holds_alternative<string*>(*solve->expr))
+            return nullptr;
+
+        auto it = variable_map.find(*get<string*>(*solve->expr));
+        if(it == variable_map.end() || !holds_alternative<BasicVar*>(*it->second))
+            return nullptr;
+        return get<BasicVar*>(*it->second);
+    }
+
+    return nullptr;
+}
+
+// Writes the objective, negated when maximizing, as a constant plus a sum
+// of weighted literals of the formula, each of which costs its weight when
+// it is false. The objective must be defined by an int_lin_eq constraint in
+// which its coefficient is 1 or -1. A term c * x of the sum over [l, u]
+// is c * l plus c for each x > v, or c * u plus -c for each x <= v if c is
+// negative, with l <= v < u. Returns false if there is no such constraint
+bool Encoder::get_objective_softs(SolveType type, const BasicVar& objective, long long& base,
+                                   vector<pair<string, long long>>& softs) {
+
+    int sign = type == MINIMIZE ? 1 : -1;
+    for(auto& item : items){
+        if(!holds_alternative<Constraint*>(item) || *get<Constraint*>(item)->name != "int_lin_eq")
+            continue;
+
+        auto& constr = *get<Constraint*>(item);
+        auto coefs = get_array(constr, 0);
+        auto vars = get_array(constr, 1);
+        int obj = -1;
+        for(int i = 0; i < (int)vars->size(); i++){
+            int coef = get_int_from_array(*coefs, i);
+            if(holds_alternative<string*>(*(*vars)[i]) && *get<string*>(*(*vars)[i]) == *objective.name
+                    && (coef == 1 || coef == -1))
+                obj = i;
+        }
+        if(obj < 0)
+            continue;
+
+        // sign * objective = base + the sum of c * x over the other terms
+        int obj_coef = get_int_from_array(*coefs, obj);
+        base = (long long)sign * obj_coef * get<int>(*get_const(constr, 2));
+        softs.clear();
+        unordered_map<string, size_t> soft_index;
+        for(int i = 0; i < (int)vars->size(); i++){
+            long long c = -(long long)sign * obj_coef * get_int_from_array(*coefs, i);
+            int val, left, right;
+            if(i == obj || c == 0)
+                continue;
+            if(is_int_const(*(*vars)[i], val)){
+                base += c * val;
+                continue;
+            }
+
+            auto it = variable_map.find(*get<string*>(*(*vars)[i]));
+            if(it == variable_map.end() || !get_int_domain(*get<BasicVar*>(*it->second), left, right))
+                return false;
+
+            auto var = get<BasicVar*>(*it->second);
+            base += c > 0 ? c * left : c * right;
+            for(int v = left; v < right; v++){
+                int lit = dimacs_literal(LiteralType::ORDER, var->id, v, c > 0);
+                if(lit == 0)
+                    return false;
+
+                auto [index, added] = soft_index.insert({smt_literal(lit), softs.size()});
+                if(added)
+                    softs.push_back({smt_literal(lit), 0});
+                softs[index->second].second += c > 0 ? c : -c;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+// Minimizes base plus the weights of the false soft literals in the style
+// of OLL. The soft literals are assumed, and each unsat core of these
+// assumptions raises the lower bound by the smallest weight in it, which
+// is taken off all of its literals. The core is relaxed with a counter of
+// its false literals, whose output "at least 2 are false" becomes a new
+// soft literal, and "at least k + 1" follows once "at least k" is in a
+// core. The first solution is optimal. Returns the last answer of the
+// solver, and the solution in best
+string Encoder::optimize_core_guided(vector<pair<string, long long>> softs, long long base, int sign,
+                                     string& best, ostream& log) {
+
+    struct Counter {
+        string sum;
+        int size;
+    };
+    vector<Counter> counters;
+    vector<pair<int, int>> counter_output(softs.size(), {-1, 0});
+    long long lower_bound = 0;
+    int next_symbol = 1;
+
+    // Adds the soft literal not (sum of the counter >= k) with the given weight
+    auto add_output = [&](int counter, int k, long long weight) {
+        string name = "o" + to_string(next_symbol++);
+        write_to_solver("(declare-fun " + name + " () Bool)\n(assert (= " + name + " (>= "
+                        + counters[counter].sum + " " + to_string(k) + ")))\n");
+        softs.push_back({"(not " + name + ")", weight});
+        counter_output.push_back({counter, k});
+    };
+
+    while(true){
+        vector<string> assumptions;
+        unordered_map<string, int> soft_of;
+        for(int i = 0; i < (int)softs.size(); i++){
+            if(softs[i].second == 0)
+                continue;
+            assumptions.push_back(softs[i].first);
+            soft_of[softs[i].first] = i;
+        }
+
+        string status = smt_check(assumptions);
+        if(status == "sat"){
+            write_to_solver("(get-model)\n");
+            read_smt_model(read_smt_response());
+
+            ostringstream solution;
+            print_model(solution);
+            best = solution.str();
+            return status;
+        }
+        if(status != "unsat")
+            return status;
+
+        write_to_solver(solver_type == CVC5 ? "(get-unsat-assumptions)\n" : "(get-unsat-core)\n");
+        vector<int> core;
+        for(auto& lit : parse_smt_literals(read_smt_response())){
+            auto it = soft_of.find(lit);
+            if(it != soft_of.end())
+                core.push_back(it->second);
+        }
+
+        // The formula is unsatisfiable whatever the objective
+        if(core.empty())
+            return status;
+
+        long long weight = softs[core[0]].second;
+        for(int i : core)
+            weight = min(weight, softs[i].second);
+
+        lower_bound += weight;
+        log << "%%%mzn-stat: objectiveBound=" << sign * (base + lower_bound) << "\n";
+        log << "%%%mzn-stat-end" << endl;
+
+        for(int i : core){
+            softs[i].second -= weight;
+            auto [counter, k] = counter_output[i];
+            if(counter >= 0 && k < counters[counter].size)
+                add_output(counter, k + 1, weight);
+        }
+
+        if(core.size() > 1){
+            string sum = "c" + to_string(counters.size() + 1);
+            string terms;
+            for(int i : core)
+                terms += " (ite " + negate_smt_literal(softs[i].first) + " 1 0)";
+            write_to_solver("(define-fun " + sum + " () Int (+" + terms + "))\n");
+
+            counters.push_back({sum, (int)core.size()});
+            add_output(counters.size() - 1, 2, weight);
+        }
+    }
+}
+
+// Collects the decision variables of LNS: the int and bool variables in
+// the output arrays, or the output variables if there are no output
+// arrays. The objective itself is never fixed
+void Encoder::collect_lns_vars(const BasicVar* objective) {
+
+    auto is_decision_var = [&](const BasicVar* var){
+        int left, right;
+        return var != objective && (get_int_domain(*var, left, right) || (holds_alternative<BasicParType>(*var->type)
+                                    && get<BasicParType>(*var->type) == BasicParType::BOOL));
+    };
+
+    for(auto& item : items){
+        if(!holds_alternative<Variable*>(item) || !holds_alternative<ArrayVar*>(*get<Variable*>(item)))
+            continue;
+
+        const ArrayVar* array = get<ArrayVar*>(*get<Variable*>(item));
+        if(!array->is_output)
+            continue;
+
+        size_t begin = lns_vars.size();
+        for(auto elem : *array->value){
+            if(!holds_alternative<string*>(*elem))
+                continue;
+            auto it = variable_map.find(*get<string*>(*elem));
+            if(it != variable_map.end() && holds_alternative<BasicVar*>(*it->second)
+                    && is_decision_var(get<BasicVar*>(*it->second)))
+                lns_vars.push_back(get<BasicVar*>(*it->second));
+        }
+        if(lns_vars.size() > begin)
+            lns_arrays.emplace_back(begin, lns_vars.size());
+    }
+
+    if(!lns_vars.empty())
+        return;
+
+    for(auto& item : items){
+        if(!holds_alternative<Variable*>(item) || !holds_alternative<BasicVar*>(*get<Variable*>(item)))
+            continue;
+
+        const BasicVar* var = get<BasicVar*>(*get<Variable*>(item));
+        if(var->is_output && is_decision_var(var))
+            lns_vars.push_back(var);
+    }
+    if(!lns_vars.empty())
+        lns_arrays.emplace_back(0, lns_vars.size());
+}
+
+// Searches neighbourhoods of the last solution for a better one. Each LNS
+// thread fixes some of the decision variables to their values in the
+// solution, either at random or a window of one output array, and solves
+// the rest in its own session with a short conflict limit. A neighbourhood
+// proven to have no better solution makes the next ones larger, and one
+// that hits the limit makes them smaller. Returns false if LNS_ROUNDS
+// rounds in a row found nothing better, and otherwise sets model to the
+// best of the improving models
+bool Encoder::search_neighbourhoods(const BasicVar& objective, SolveType type, int bound, string& model) {
+
+    const int LNS_ROUNDS = 8;
+    const long long LNS_CONFLICT_LIMIT = 1000;
+
+    if(lns_vars.empty())
+        return false;
+
+    // The literals fixing each decision variable to its value in the solution
+    vector<vector<string>> fixed(lns_vars.size());
+    for(size_t i = 0; i < lns_vars.size(); i++){
+        const BasicVar& var = *lns_vars[i];
+        int value, lit;
+        if(decode_int(var, value)){
+            if((lit = dimacs_literal(LiteralType::ORDER, var.id, value, true)) != 0)
+                fixed[i].push_back(smt_literal(lit));
+            if((lit = dimacs_literal(LiteralType::ORDER, var.id, value - 1, false)) != 0)
+                fixed[i].push_back(smt_literal(lit));
+        } else if((value = model_value(LiteralType::BOOL_VARIABLE, var.id, 0)) >= 0
+                  && (lit = dimacs_literal(LiteralType::BOOL_VARIABLE, var.id, 0, value == 1)) != 0){
+            fixed[i].push_back(smt_literal(lit));
+        }
+    }
+
+    int threads = options.lns_threads;
+    lns_workers.resize(threads);
+    uniform_real_distribution<double> coin(0.0, 1.0);
+    for(int round = 0; round < LNS_ROUNDS && time_left() != 0; round++){
+        vector<vector<string>> assumptions(threads, {smt_literal(bound)});
+        for(int t = 0; t < threads; t++){
+            vector<bool> is_free(lns_vars.size(), false);
+            if((round + t) % 2 == 0){
+                for(size_t i = 0; i < lns_vars.size(); i++)
+                    is_free[i] = coin(lns_random) < lns_free;
             } else {
-                if(*left < val + 1)
-                    *left = val + 1;
+                auto [begin, end] = lns_arrays[lns_random() % lns_arrays.size()];
+                size_t length = min(end - begin, max<size_t>(1, lns_free * lns_vars.size()));
+                size_t start = begin + lns_random() % (end - begin - length + 1);
+                fill(is_free.begin() + start, is_free.begin() + start + length, true);
             }
 
-            if(*left == *right){
-                curr_basic_var->value = new BasicExpr(new BasicLiteralExpr(*left));
+            for(size_t i = 0; i < lns_vars.size(); i++)
+                if(!is_free[i])
+                    assumptions[t].insert(assumptions[t].end(), fixed[i].begin(), fixed[i].end());
+        }
 
-                id_map.erase(l->id);
-                
-                if(curr_basic_var->is_output)
-                    cout << *curr_basic_var->name << " = " << *left << ";\n";
-            } 
-        } else if(holds_alternative<SetVarType*>(*curr_basic_var_type)){
-                if(!sign)
-                    set_variable_map[l->id].insert(l->val);
-        } else if(holds_alternative<BasicParType>(*curr_basic_var_type)){
-            if(get<BasicParType>(*curr_basic_var_type) == BasicParType::BOOL){
+        vector<string> statuses(threads), models(threads);
+        auto work = [&](int t){
+            auto& worker = lns_workers[t];
+            if(worker == nullptr){
+                worker.reset(new Encoder(this));
+                worker->options.conflict_limit = options.conflict_limit > 0 ? min(options.conflict_limit, LNS_CONFLICT_LIMIT)
+                                                                            : LNS_CONFLICT_LIMIT;
+                worker->start_smt_solver();
+                worker->send_file_to_solver(scratch_path("formula.smt2"));
+            }
+
+            statuses[t] = worker->smt_check(assumptions[t]);
+            if(statuses[t] == "sat"){
+                worker->write_to_solver("(get-model)\n");
+                models[t] = worker->read_smt_response();
+            }
+        };
+
+        vector<thread> pool;
+        for(int t = 0; t < threads; t++)
+            pool.emplace_back(work, t);
+        for(auto& t : pool)
+            t.join();
+
+        int best_value = 0;
+        for(int t = 0; t < threads; t++){
+            if(statuses[t] == "unsat")
+                lns_free = min(1.0, lns_free * 1.25);
+            else if(statuses[t] != "sat")
+                lns_free = max(1.0 / lns_vars.size(), lns_free * 0.8);
+            if(statuses[t] != "sat")
+                continue;
 
+            read_smt_model(models[t]);
+            int value;
+            if(decode_int(objective, value) && (model.empty() || (type == MINIMIZE ? value < best_value : value > best_value))){
+                best_value = value;
+                model = models[t];
+            }
+        }
 
-                if(!sign){
-                    curr_basic_var->value = new BasicExpr(new BasicLiteralExpr(true));
-                    if(curr_basic_var->is_output)
-                        cout << *curr_basic_var->name << " = true;\n"; 
-                    
-                } else {
-                    curr_basic_var->value = new BasicExpr(new BasicLiteralExpr(false));
-                    if(curr_basic_var->is_output)                  
-                        cout << *curr_basic_var->name << " = false;\n";
-                } 
-                id_map.erase(l->id);                    
+        if(!model.empty())
+            return true;
+    }
+
+    return false;
+}
+
+// Solves the problem in a single session with the SMT solver. The formula
+// is declared once, and for an optimisation problem the bound that each
+// solution sets for the next one is passed to (check-sat-assuming), so
+// that the solver keeps what it has learned from one bound to the next.
+// With the core_guided option, an objective defined by a linear sum is
+// minimized from below with the unsat cores of the solver instead. With
+// the anytime option every solution is printed as soon as it is found,
+// and the search stops with the best one when the time limit is reached.
+// With the lns option, better solutions are searched for around each one
+// before the whole problem is solved again
+void Encoder::optimize(ostream& out, ostream& log) {
+
+    if(unsat){
+        print_answer(out, "unsat");
+        return;
+    }
+
+    start_smt_solver();
+    if(solver_pid < 0)
+        return;
+    send_file_to_solver(scratch_path("formula.smt2"));
+
+    SolveType type = ORDINARY;
+    BasicVar* objective = get_objective(type);
+
+    string status;
+    string best;
+    bool optimal = false;
+    vector<pair<string, long long>> softs;
+    long long base;
+    if(options.core_guided && objective != nullptr && get_objective_softs(type, *objective, base, softs)){
+        status = optimize_core_guided(softs, base, type == MINIMIZE ? 1 : -1, best, log);
+        optimal = status == "sat";
+        if(options.anytime && optimal)
+            out << best << "----------" << endl;
+    } else {
+        if(options.lns && objective != nullptr)
+            collect_lns_vars(objective);
+
+        status = smt_check({});
+        string model;
+        while(status == "sat"){
+            if(model.empty()){
+                write_to_solver("(get-model)\n");
+                model = read_smt_response();
             }
+            read_smt_model(model);
+            model.clear();
+
+            ostringstream solution;
+            print_model(solution);
+            best = solution.str();
+            if(options.anytime)
+                out << best << "----------" << endl;
+
+            int value;
+            if(objective == nullptr || !decode_int(*objective, value))
+                break;
+
+            // Minimizing, the next solution needs x <= value - 1, and
+            // maximizing it needs not x <= value. Without the literal there
+            // is no better value in the domain
+            int bound = type == MINIMIZE ? dimacs_literal(LiteralType::ORDER, objective->id, value - 1, true)
+                                         : dimacs_literal(LiteralType::ORDER, objective->id, value, false);
+            if(bound == 0){
+                optimal = true;
+                break;
+            }
+
+            // With LNS, the whole problem is only solved again once the
+            // neighbourhoods of the solution stop improving it
+            if(options.lns && search_neighbourhoods(*objective, type, bound, model))
+                continue;
+
+            status = smt_check({smt_literal(bound)});
         }
+        optimal = optimal || (objective != nullptr && status == "unsat");
+    }
+
+    read_from_solver();
+    for(auto& worker : lns_workers)
+        if(worker != nullptr)
+            worker->read_from_solver();
 
+    if(best.empty()){
+        if(status == "unsat" || status == "unknown")
+            print_answer(out, status);
+        else
+            log << "Unexpected solver answer: " << status << "\n";
+        return;
     }
 
-    for(auto set_var : set_variable_map){
+    // A solution that is not proven optimal is the best one found in time
+    if(!options.anytime)
+        print_answer(out, "sat", best);
+    else if(optimal)
+        out << "==========" << endl;
+}
+
+// Runs all solver configurations of the portfolio on formula.cnf in parallel.
+// The output of the first solver to answer SAT or UNSAT is kept for
+// read_solver_output, and the other solvers are stopped
+void Encoder::run_portfolio() {
+
+    struct Run {
+        pid_t pid;
+        int out = -1;
+        string output;
+    };
+
+    vector<Run> runs(options.portfolio.size());
+    int running = 0;
+    for(int i = 0; i < (int)runs.size(); i++){
+        auto& [solver, seed] = options.portfolio[i];
+        runs[i].pid = spawn_process(solver_command(solver, seed, scratch_path("formula.cnf"), options.conflict_limit), nullptr, &runs[i].out);
+        if(runs[i].pid > 0)
+            running++;
+    }
+
+    int winner = -1;
+    char chunk[1 << 16];
+    while(winner < 0 && running > 0){
+        vector<pollfd> fds;
+        vector<int> run_of;
+        for(int i = 0; i < (int)runs.size(); i++)
+            if(runs[i].out >= 0){
+                fds.push_back({runs[i].out, POLLIN, 0});
+                run_of.push_back(i);
+            }
 
-        if(!(get<BasicVar*>(*id_map[set_var.first])->is_output))
+        int ready = poll(fds.data(), fds.size(), poll_timeout());
+        if(ready < 0 && errno == EINTR)
             continue;
+        if(ready <= 0)
+            break;
+
+        for(int j = 0; j < (int)fds.size() && winner < 0; j++){
+            if(fds[j].revents == 0)
+                continue;
+
+            Run& run = runs[run_of[j]];
+            ssize_t n = read(run.out, chunk, sizeof(chunk));
+            if(n < 0 && errno == EINTR)
+                continue;
+            if(n > 0){
+                run.output.append(chunk, n);
+                continue;
+            }
+
+            // The solver closed its output, so it is done
+            close(run.out);
+            run.out = -1;
+            waitpid(run.pid, nullptr, 0);
+            run.pid = -1;
+            running--;
+
+            if(has_solver_answer(run.output))
+                winner = run_of[j];
+        }
+    }
+
+    for(auto& run : runs){
+        if(run.pid > 0)
+            kill(-run.pid, SIGTERM);
+        if(run.out >= 0)
+            close(run.out);
+        if(run.pid > 0)
+            waitpid(run.pid, nullptr, 0);
+    }
+
+    if(winner < 0){
+        if(time_left() != 0)
+            cerr << "No solver of the portfolio gave an answer\n";
+        return;
+    }
+
+    solver_output = runs[winner].output;
+    portfolio_winner = solver_config_name(options.portfolio[winner]);
+}
+
+// Writes a part of the DIMACS formula to the solver's input
+void Encoder::write_to_solver(const string& buffer) {
 
-        cout << *get<BasicVar*>(*id_map[set_var.first])->name << " = {";
-        if(set_var.second.empty()){
-            cout << "}\n";
+    size_t written = 0;
+    while(solver_in >= 0 && written < buffer.size()){
+        ssize_t n = write(solver_in, buffer.data() + written, buffer.size() - written);
+        if(n < 0){
+            if(errno == EINTR)
+                continue;
+
+            cerr << "Cannot write to the solver\n";
+            close(solver_in);
+            solver_in = -1;
+            return;
+        }
+        written += n;
+    }
+}
+
+// Closes the solver's input, collects everything the solver writes
+// to its output and waits for it to exit. A solver still running at the
+// time limit is stopped, and its output is dropped as it has no answer
+string Encoder::read_from_solver() {
+
+    if(solver_in >= 0){
+        close(solver_in);
+        solver_in = -1;
+    }
+
+    string result;
+    char chunk[1 << 16];
+    while(solver_out >= 0){
+        pollfd fd = {solver_out, POLLIN, 0};
+        int ready = poll(&fd, 1, poll_timeout());
+        if(ready < 0 && errno == EINTR)
             continue;
+        if(ready == 0 && solver_pid > 0){
+            kill(-solver_pid, SIGTERM);
+            result.clear();
+            break;
         }
 
-        for(auto it = set_var.second.begin(); it != prev(set_var.second.end()); it++){
-            cout << *it << ", ";
+        ssize_t n = read(solver_out, chunk, sizeof(chunk));
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        result.append(chunk, n);
+    }
+
+    if(solver_out >= 0){
+        close(solver_out);
+        solver_out = -1;
+    }
+    if(solver_pid > 0){
+        waitpid(solver_pid, nullptr, 0);
+        solver_pid = -1;
+    }
+
+    return result;
+}
+
+// A file mapped into memory for reading. A file that cannot be mapped,
+// such as an empty one, is read into a buffer instead
+struct MappedFile {
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+    string buffer;
+
+    bool open(const string& path){
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return false;
+
+        struct stat st;
+        if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0){
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p != MAP_FAILED){
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char*>(p);
+                size = st.st_size;
+                mapped = true;
+                ::close(fd);
+                return true;
+            }
         }
-        
-        cout << *prev(set_var.second.end()) << "};\n";
+
+        char chunk[1 << 16];
+        ssize_t n;
+        while((n = read(fd, chunk, sizeof(chunk))) > 0 || (n < 0 && errno == EINTR))
+            if(n > 0)
+                buffer.append(chunk, n);
+        ::close(fd);
+
+        data = buffer.data();
+        size = buffer.size();
+        return true;
     }
 
+    void close(){
+        if(mapped)
+            munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+        mapped = false;
+        buffer.clear();
+    }
 
-    for(auto array : array_set){
-        auto elems = array->value;
+    ~MappedFile(){
+        close();
+    }
+};
 
-        cout << *array->name << " = array1d(1.." << array->value->size() << ",[";
+// Reads the solver output, converts it to a human readable format
+// and writes it to the given stream, by default cout
+void Encoder::read_solver_output(const string& outputFile, ostream& out) {
 
-        int i = 0;
-        for(auto elem : *elems){
-            if(holds_alternative<string*>(*elem)){
+    if(unsat){
+        if(solver_pid > 0){
+            kill(-solver_pid, SIGTERM);
+            read_from_solver();
+        }
 
-                auto var = get<BasicVar*>(*variable_map[*get<string*>(*elem)]);
-                auto val = get<BasicLiteralExpr*>(*var->value);
+        print_answer(out, "unsat");
+        return;
+    }
 
-                if(holds_alternative<IntRangeVarType*>(*var->type) || holds_alternative<IntSetVarType*>(*var->type)){
-                    cout << get<int>(*val);
-                } else if(holds_alternative<BasicParType>(*var->type)){
-                    auto type = get<BasicParType>(*var->type);
-                    
-                    if(type == BasicParType::BOOL){
-                        cout << get<bool>(*val);
-                    } else {
-                        cout << get<int>(*val);
-                    }
-                }
-            } else {
-                auto expr = get<BasicLiteralExpr*>(*elem);
-                if(holds_alternative<int>(*expr)){
-                    cout << get<int>(*expr);
-                } else {
-                    cout << get<bool>(*expr);
-                }    
+    // The SMT solver has been given the formula, followed by (check-sat)
+    // and (get-model), so it answers with the status and then the model
+    if(file_type == SMTLIB){
+        if(solver_pid <= 0){
+            cerr << "The solver is not running\n";
+            return;
+        }
+
+        string status = read_smt_response();
+        string model = read_smt_response();
+        read_from_solver();
+
+        if(status != "sat"){
+            print_answer(out, status == "unsat" ? "unsat" : "unknown");
+            return;
+        }
+
+        ostringstream solution;
+        read_smt_model(model);
+        print_model(solution);
+        print_answer(out, "sat", solution.str());
+        return;
+    }
+
+    string piped;
+    MappedFile file;
+    const char* p;
+    const char* end;
+    if(options.pipe_solver){
+        if(solver_pid <= 0){
+            cerr << "The solver is not running\n";
+            return;
+        }
+        piped = read_from_solver();
+        p = piped.data();
+        end = p + piped.size();
+    } else if(!options.portfolio.empty()){
+        if(portfolio_winner.empty()){
+            print_answer(out, "unknown");
+            return;
+        }
+        p = solver_output.data();
+        end = p + solver_output.size();
+    } else {
+        if(!file.open(scratch_path(outputFile))){
+            // A solver stopped at the time limit may not have written it
+            if(time_left() == 0){
+                print_answer(out, "unknown");
+                return;
+            }
+            cerr << "Cannot open file\n";
+            return;
+        }
+        p = file.data;
+        end = p + file.size;
+    }
+
+    // Solvers may print other text before the status, e.g. the s prefix
+    // of the competition format or a warning of minisat. A solver that
+    // stopped at its conflict limit answers neither SAT nor UNSAT
+    string_view status;
+    while(p < end){
+        while(p < end && isspace(static_cast<unsigned char>(*p)))
+            p++;
+        const char* token = p;
+        while(p < end && !isspace(static_cast<unsigned char>(*p)))
+            p++;
+
+        string_view curr(token, p - token);
+        if(curr.find("SAT") != curr.npos || curr.find("sat") != curr.npos){
+            status = curr;
+            break;
+        }
+    }
+    if(status.find("UNSAT") != status.npos || status.find("unsat") != status.npos){
+        print_answer(out, "unsat");
+        return;
+    }
+    if(status.empty()){
+        print_answer(out, "unknown");
+        return;
+    }
+
+    ostringstream solution;
+    read_model(p, end);
+    print_model(solution);
+    print_answer(out, "sat", solution.str());
+}
+
+// Writes the answer sat, unsat or unknown, with the solution for sat. The
+// converter's format starts with SAT, UNSAT or UNKNOWN. With the anytime
+// option the MiniZinc format is used, where a solution ends with ----------
+void Encoder::print_answer(ostream& out, const string& status, const string& solution) const {
+
+    if(status == "sat"){
+        if(options.anytime)
+            out << solution << "----------" << endl;
+        else
+            out << "SAT\n" << solution << flush;
+    } else if(status == "unsat") {
+        out << (options.anytime ? "=====UNSATISFIABLE=====" : "UNSAT") << endl;
+    } else {
+        out << (options.anytime ? "=====UNKNOWN=====" : "UNKNOWN") << endl;
+    }
+}
+
+// Sets the bits of the DIMACS variables that appear as literals in the
+// solver's model. Other tokens, such as the v prefix of the competition
+// format, are skipped
+void Encoder::read_model(const char* p, const char* end) {
+
+    model_assigned.assign(next_dimacs_num, false);
+    model_values.assign(next_dimacs_num, false);
+
+    while(p < end){
+        while(p < end && isspace(static_cast<unsigned char>(*p)))
+            p++;
+
+        bool negative = p < end && *p == '-';
+        if(negative)
+            p++;
+
+        const char* digits = p;
+        long num = 0;
+        while(p < end && *p >= '0' && *p <= '9' && num < next_dimacs_num)
+            num = num * 10 + (*p++ - '0');
+
+        if(p == digits || (p < end && !isspace(static_cast<unsigned char>(*p)))){
+            while(p < end && !isspace(static_cast<unsigned char>(*p)))
+                p++;
+            continue;
+        }
+
+        if(num > 0 && num < next_dimacs_num){
+            model_assigned[num] = true;
+            model_values[num] = !negative;
+        }
+    }
+}
+
+// Sets the bits of the DIMACS variables defined in a model of the SMT
+// solver, which has the form ((define-fun x12 () Bool true) ...), possibly
+// with the keyword model after the first parenthesis
+void Encoder::read_smt_model(const string& model) {
+
+    model_assigned.assign(next_dimacs_num, false);
+    model_values.assign(next_dimacs_num, false);
+
+    size_t pos = 0;
+    while(pos < model.size()){
+        if(next_smt_token(model, pos) != "define-fun")
+            continue;
+
+        string_view name = next_smt_token(model, pos);
+        if(name.size() > 2 && name.front() == '|' && name.back() == '|')
+            name = name.substr(1, name.size() - 2);
+
+        if(next_smt_token(model, pos) != "(" || next_smt_token(model, pos) != ")"
+                || next_smt_token(model, pos) != "Bool")
+            continue;
+        string_view value = next_smt_token(model, pos);
+
+        if(name.size() < 2 || name[0] != 'x')
+            continue;
+        long num = 0;
+        for(char c : name.substr(1)){
+            if(!isdigit(static_cast<unsigned char>(c)) || num >= next_dimacs_num){
+                num = 0;
+                break;
+            }
+            num = num * 10 + (c - '0');
+        }
+
+        if(num > 0 && num < next_dimacs_num && (value == "true" || value == "false")){
+            model_assigned[num] = true;
+            model_values[num] = value == "true";
+        }
+    }
+}
+
+// Returns the DIMACS literal of a literal of the encoding, or 0 if the
+// literal does not occur in the formula
+int Encoder::dimacs_literal(LiteralType type, int id, int val, bool pol) const {
+
+    auto it = literal_to_num.find(make_tuple(type, id, val));
+    if(it == literal_to_num.end())
+        return 0;
+
+    return pol ? it->second : -it->second;
+}
+
+// Returns 1 if the literal is true in the model, 0 if it is false and
+// -1 if it is not in the formula or the solver did not set it
+int Encoder::model_value(LiteralType type, int id, int val) const {
+
+    auto it = literal_to_num.find(make_tuple(type, id, val));
+    if(it == literal_to_num.end() || !model_assigned[it->second])
+        return -1;
+
+    return model_values[it->second];
+}
+
+// Finds the value of an integer variable with a binary search for the
+// smallest v in its domain whose order literal x <= v is true
+bool Encoder::decode_int(const BasicVar& var, int& value) const {
+
+    int left, right;
+    if(!get_int_domain(var, left, right))
+        return false;
+
+    while(left < right){
+        int mid = left + (right - left) / 2;
+        if(model_value(LiteralType::ORDER, var.id, mid) == 1)
+            right = mid;
+        else
+            left = mid + 1;
+    }
+
+    value = left;
+    return model_value(LiteralType::ORDER, var.id, left) == 1;
+}
+
+// Writes a set of integers in the MiniZinc output format
+string format_set(const set<int>& elems){
+
+    string text = "{";
+    for(auto it = elems.begin(); it != elems.end(); it++){
+        if(it != elems.begin())
+            text += ", ";
+        text += to_string(*it);
+    }
+    return text + "}";
+}
+
+// Writes a constant of the model in the MiniZinc output format. Booleans
+// are written as 1 and 0, as the elements of the output arrays always were
+string format_literal(const BasicLiteralExpr& expr){
+
+    if(holds_alternative<int>(expr))
+        return to_string(get<int>(expr));
+    if(holds_alternative<bool>(expr))
+        return to_string((int)get<bool>(expr));
+
+    set<int> elems;
+    auto set_literal = get<SetLiteral*>(expr);
+    if(holds_alternative<SetRangeLiteral*>(*set_literal)){
+        auto range = get<SetRangeLiteral*>(*set_literal);
+        for(int i = range->left; i <= range->right; i++)
+            elems.insert(i);
+    } else {
+        for(int elem : *get<SetSetLiteral*>(*set_literal)->elems)
+            elems.insert(elem);
+    }
+    return format_set(elems);
+}
+
+// Writes the value of an element of an output array: a constant, a
+// parameter or a variable of the model. Returns false if the element
+// cannot be decoded
+bool Encoder::format_output_elem(const BasicExpr& elem, string& text) const {
+
+    if(holds_alternative<BasicLiteralExpr*>(elem)){
+        text = format_literal(*get<BasicLiteralExpr*>(elem));
+        return true;
+    }
+
+    const string& name = *get<string*>(elem);
+    auto param = parameter_map.find(name);
+    if(param != parameter_map.end()){
+        if(!holds_alternative<BasicLiteralExpr*>(*param->second->value))
+            return false;
+        text = format_literal(*get<BasicLiteralExpr*>(*param->second->value));
+        return true;
+    }
+
+    auto it = variable_map.find(name);
+    if(it == variable_map.end() || !holds_alternative<BasicVar*>(*it->second))
+        return false;
+
+    auto var = get<BasicVar*>(*it->second);
+    if(holds_alternative<SetVarType*>(*var->type)){
+        set<int> elems;
+        for(int elem : *get<SetVarType*>(*var->type)->elems)
+            if(model_value(LiteralType::SET_ELEM, var->id, elem) == 1)
+                elems.insert(elem);
+        text = format_set(elems);
+        return true;
+    }
+
+    if(holds_alternative<BasicParType>(*var->type) && get<BasicParType>(*var->type) == BasicParType::BOOL){
+        text = to_string(model_value(LiteralType::BOOL_VARIABLE, var->id, 0) == 1);
+        return true;
+    }
+
+    int value;
+    if(!decode_int(*var, value))
+        return false;
+    text = to_string(value);
+    return true;
+}
+
+// Writes the values of the output variables and arrays in the order of
+// their declarations. Only the literals of these variables are looked up
+void Encoder::print_model(ostream& out) const {
+
+    for(auto& item : items){
+        if(!holds_alternative<Variable*>(item))
+            continue;
+
+        Variable* var = get<Variable*>(item);
+        if(holds_alternative<BasicVar*>(*var)){
+            const BasicVar* basic_var = get<BasicVar*>(*var);
+            if(!basic_var->is_output)
+                continue;
+
+            int value;
+            if(holds_alternative<SetVarType*>(*basic_var->type)){
+                set<int> elems;
+                for(int elem : *get<SetVarType*>(*basic_var->type)->elems)
+                    if(model_value(LiteralType::SET_ELEM, basic_var->id, elem) == 1)
+                        elems.insert(elem);
+
+                out << *basic_var->name << " = " << format_set(elems) << ";\n";
+            } else if(holds_alternative<BasicParType>(*basic_var->type)){
+                if(get<BasicParType>(*basic_var->type) != BasicParType::BOOL)
+                    continue;
+
+                int val = model_value(LiteralType::BOOL_VARIABLE, basic_var->id, 0);
+                if(val == 1)
+                    out << *basic_var->name << " = true;\n";
+                else if(val == 0)
+                    out << *basic_var->name << " = false;\n";
+            } else if(decode_int(*basic_var, value)){
+                out << *basic_var->name << " = " << value << ";\n";
             }
+            continue;
+        }
 
-            if(i++ < (int)elems->size() - 1)
-                cout << ", ";
-            else    
-                cout << "]);\n";
+        const ArrayVar* array = get<ArrayVar*>(*var);
+        if(!array->is_output)
+            continue;
+
+        // The array is only written once all of its elements are decoded,
+        // so that no shorter array is printed
+        auto elems = array->value;
+        string text = *array->name + " = array1d(1.." + to_string(elems->size()) + ",[";
+        bool decoded = true;
+        for(size_t i = 0; i < elems->size() && decoded; i++){
+            string elem_text;
+            decoded = format_output_elem(*(*elems)[i], elem_text);
+            text += (i > 0 ? ", " : "") + elem_text;
         }
+
+        if(!decoded){
+            cerr << "Cannot decode the value of an element of " << *array->name << "\n";
+            continue;
+        }
+        out << text << "]);\n";
+    }
+}
+
+// Splits an SMT-LIB script into its top-level commands. Parentheses in
+// strings, quoted symbols and comments are not counted
+vector<string_view> split_smt_commands(string_view text){
+
+    vector<string_view> commands;
+    size_t begin = 0;
+    int depth = 0;
+    char quote = 0;
+    for(size_t i = 0; i < text.size(); i++){
+        char c = text[i];
+        if(quote){
+            if(c == quote)
+                quote = 0;
+        } else if(c == ';'){
+            while(i + 1 < text.size() && text[i + 1] != '\n')
+                i++;
+        } else if(c == '"' || c == '|'){
+            quote = c;
+        } else if(c == '('){
+            if(depth++ == 0)
+                begin = i;
+        } else if(c == ')' && depth > 0 && --depth == 0){
+            commands.push_back(text.substr(begin, i + 1 - begin));
+        }
+    }
+
+    return commands;
+}
+
+// Writes the checks of each file of proof obligations in a directory of
+// the working directory to their own files in its checks directory
+void Encoder::split_proof_files(const string& dir) const {
+
+    filesystem::path proof_dir = scratch_path(dir);
+    filesystem::create_directories(proof_dir / "checks");
+
+    vector<filesystem::path> files;
+    for(auto& entry : filesystem::directory_iterator(proof_dir))
+        if(entry.is_regular_file() && entry.path().extension() == ".smt2")
+            files.push_back(entry.path());
+    sort(files.begin(), files.end());
+
+    for(auto& file : files)
+        split_proof_file(file, proof_dir / "checks");
+}
+
+// Writes each check of a file of proof obligations, a block between (push)
+// and (pop), to a file of its own, numbered in the order of the checks.
+// The file has the options of the proof and only the declarations and
+// definitions that the check uses, directly or through other definitions,
+// so that the checks can be run independently of each other
+void Encoder::split_proof_file(const filesystem::path& path, const filesystem::path& dir) const {
+
+    MappedFile file;
+    if(!file.open(path.string())){
+        cerr << "Cannot open file " << path.string() << "\n";
+        return;
     }
+    vector<string_view> commands = split_smt_commands(string_view(file.data, file.size));
+
+    // The symbols declared or defined by the commands before the checks,
+    // and for each definition the ones it uses
+    size_t first_check = 0;
+    unordered_map<string, size_t> defined_by;
+    vector<bool> is_definition(commands.size(), false);
+    for(; first_check < commands.size() && commands[first_check] != "(push)"; first_check++){
+        string command(commands[first_check]);
+        size_t pos = 0;
+        next_smt_token(command, pos);
+        string_view head = next_smt_token(command, pos);
+        if(head.rfind("declare-", 0) == 0 || head.rfind("define-", 0) == 0){
+            defined_by[string(next_smt_token(command, pos))] = first_check;
+            is_definition[first_check] = true;
+        }
+    }
+
+    auto used_definitions = [&](string_view text, size_t skip, vector<size_t>& used){
+        string command(text);
+        size_t pos = 0;
+        for(string_view token = next_smt_token(command, pos); !token.empty(); token = next_smt_token(command, pos)){
+            auto it = defined_by.find(string(token));
+            if(it != defined_by.end() && it->second != skip)
+                used.push_back(it->second);
+        }
+    };
+
+    vector<vector<size_t>> uses(first_check);
+    for(size_t i = 0; i < first_check; i++)
+        if(is_definition[i])
+            used_definitions(commands[i], i, uses[i]);
+
+    string stem = path.stem().string();
+    int check_num = 0;
+    vector<bool> needed(first_check);
+    for(size_t begin = first_check; begin < commands.size(); begin++){
+        if(commands[begin] != "(push)")
+            continue;
+        size_t end = begin + 1;
+        while(end < commands.size() && commands[end] != "(pop)")
+            end++;
+
+        fill(needed.begin(), needed.end(), false);
+        vector<size_t> todo;
+        for(size_t i = begin + 1; i < end; i++)
+            used_definitions(commands[i], first_check, todo);
+        while(!todo.empty()){
+            size_t i = todo.back();
+            todo.pop_back();
+            if(needed[i])
+                continue;
+            needed[i] = true;
+            todo.insert(todo.end(), uses[i].begin(), uses[i].end());
+        }
+
+        ProofWriter check;
+        check.open((dir / (stem + "_" + to_string(++check_num) + ".smt2")).string());
+        for(size_t i = 0; i < first_check; i++)
+            if(!is_definition[i] || needed[i])
+                check << commands[i] << "\n";
+        for(size_t i = begin + 1; i < end; i++)
+            check << commands[i] << "\n";
 
-    output.close();
+        begin = end;
+    }
 }
 
 // Encodes a parameter of the model 
@@ -3392,6 +5449,8 @@ void Encoder::encode_variable(Variable& var, CNF& cnf_clauses) {
             if(export_proof){
                 isLIA = true;
 
+                encode_direct(*basic_var, cnf_clauses, sat_dom_clauses);
+
                 trivial_encoding_vars << "(declare-const " << *basic_var->name << " Int)\n";
 
                 string left_string = left < 0 ? ("(- " + to_string(-left) + ")") : to_string(left);
@@ -3458,6 +5517,8 @@ void Encoder::encode_variable(Variable& var, CNF& cnf_clauses) {
             if(export_proof){
                 isLIA = true;
 
+                encode_direct(*basic_var, cnf_clauses, sat_dom_clauses);
+
                 trivial_encoding_vars << "(declare-const " << *basic_var->name << " Int)\n";
 
                 if(n > 1)
@@ -3521,7 +5582,9 @@ void Encoder::encode_variable(Variable& var, CNF& cnf_clauses) {
                 if(bv_right < v[v.size()-1])
                     bv_right = v[v.size()-1];
 
-                trivial_encoding_vars << "(declare-const " << *basic_var->name << " (_ BitVec \n"; 
+                trivial_encoding_vars << "(declare-const " << *basic_var->name << " (_ BitVec ";
+                trivial_encoding_vars.mark();
+                trivial_encoding_vars << "\n";
             }
 
         } else if(holds_alternative<BasicParType>(*basic_var->type)){
@@ -3559,9 +5622,6 @@ void Encoder::encode_variable(Variable& var, CNF& cnf_clauses) {
     } else {
         ArrayVar* array_var = get<ArrayVar*>(var);
         variable_map[*array_var->name] = &var;  
-        
-        if(array_var->is_output)
-            array_set.insert(array_var);
     }
 }
 
@@ -3614,6 +5674,8 @@ BasicVar* Encoder::encode_int_range_helper_variable(const int left, const int ri
     if(export_proof){
         isLIA = true;
 
+        encode_direct(*int_range_var, cnf_clauses, is2step_var ? sat_dom_clauses2step : sat_dom_clauses);
+
         trivial_encoding_vars << "(declare-const " << *int_range_var->name << " Int)\n";
 
         
@@ -3702,40 +5764,151 @@ int get_right(const BasicVar* var){
         return 1;
 }
 
-// Makes a connection between a direct and order encoding of a variable.
-// The variable is supposed to already be encoded using the order encoding
-void Encoder::encode_direct(const BasicVar& var, CNF& cnf_clauses){
-    
+// Adds the direct literal (var = val) and connects it to the order
+// encoding of the variable. This is done only once per value
+void Encoder::encode_direct_value(const BasicVar& var, int val, CNF& cnf_clauses, CNF* dom_clauses){
+
+    // A worker of the parallel encoder does not repeat the values its parent has encoded
+    auto parent_values = parent == nullptr ? nullptr : parent->find_cached(&Encoder::direct_encoded_values, var.id);
+    if(parent_values != nullptr && parent_values->count(val) > 0)
+        return;
+
+    if(!direct_encoded_values[var.id].insert(val).second)
+        return;
+
+    LiteralPtr p = make_literal(LiteralType::DIRECT, var.id, true, val);
+    LiteralPtr q = make_literal(LiteralType::ORDER, var.id, true, val);
+    LiteralPtr r = make_literal(LiteralType::ORDER, var.id, true, val-1);
+    LiteralPtr not_p = make_literal(LiteralType::DIRECT, var.id, false, val);
+    LiteralPtr not_q = make_literal(LiteralType::ORDER, var.id, false, val);
+    LiteralPtr not_r = make_literal(LiteralType::ORDER, var.id, false, val-1);
+
+    Clause new_clause1 = {not_p, q};
+    Clause new_clause2 = {not_p, not_r};
+    Clause new_clause3 = {p, not_q, r};
+    cnf_clauses.push_back(new_clause1);
+    cnf_clauses.push_back(new_clause2);
+    cnf_clauses.push_back(new_clause3);
+
+    if(dom_clauses != nullptr){
+        dom_clauses->push_back(new_clause1);
+        dom_clauses->push_back(new_clause2);
+        dom_clauses->push_back(new_clause3);
+    }
+}
+
+// Makes the direct literals for the whole domain of a variable, right
+// after its order encoding. This is used in the proof, where the clauses
+// connecting the two encodings have to be part of the variable's domain
+void Encoder::encode_direct(const BasicVar& var, CNF& cnf_clauses, CNF& dom_clauses){
+
     int left = get_left(&var);
     int right = get_right(&var);
 
-    for(int i = left; i <= right; i++){
-        LiteralPtr p = make_literal(LiteralType::DIRECT, var.id, true, i);
-        LiteralPtr q = make_literal(LiteralType::ORDER, var.id, true, i);
-        LiteralPtr r = make_literal(LiteralType::ORDER, var.id, true, i-1);
-        LiteralPtr not_p = make_literal(LiteralType::DIRECT, var.id, false, i);
-        LiteralPtr not_q = make_literal(LiteralType::ORDER, var.id, false, i);
-        LiteralPtr not_r = make_literal(LiteralType::ORDER, var.id, false, i-1);
-
-        Clause new_clause1 = {not_p, q};
-        Clause new_clause2 = {not_p, not_r};
-        Clause new_clause3 = {p, not_q, r};
-        cnf_clauses.push_back(new_clause1);
-        cnf_clauses.push_back(new_clause2);
-        cnf_clauses.push_back(new_clause3);
+    for(int i = left; i <= right; i++)
+        encode_direct_value(var, i, cnf_clauses, &dom_clauses);
+}
 
-        if(export_proof){
-            sat_dom_clauses.push_back(new_clause1);
-            sat_dom_clauses.push_back(new_clause2);
-            sat_dom_clauses.push_back(new_clause3);            
+// Returns the direct literal (var = val) with the given polarity.
+// The variable is supposed to already be encoded using the order encoding.
+// The connection between the direct literal and the order encoding is made
+// on the first reference to the value, so a variable only gets direct
+// literals for the values some constraint actually mentions. In the proof
+// the whole domain already got them together with the variable
+LiteralPtr Encoder::get_direct_literal(const BasicVar& var, int val, bool pol, CNF& cnf_clauses){
+
+    if(!export_proof)
+        encode_direct_value(var, val, cnf_clauses);
+
+    return make_literal(LiteralType::DIRECT, var.id, pol, val);
+}
+
+// Returns a literal that is false when the index b selects the i-th
+// array element. Outside of the proof this is just the negated direct
+// literal (b = i), which is shared by all element constraints over b.
+// In the proof it is a helper with its own definition
+LiteralPtr Encoder::encode_index_selector(const BasicVar& b, int i, CNF& cnf_clauses){
+
+    if(!export_proof)
+        return get_direct_literal(b, i, false, cnf_clauses);
+
+    LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
+    Clause new_clause1 = { make_literal(LiteralType::ORDER, b.id, true, i), helper};
+    Clause new_clause2 = { make_literal(LiteralType::ORDER, b.id, false, i-1), helper};
+    cnf_clauses.push_back(new_clause1);
+    cnf_clauses.push_back(new_clause2);
+
+    helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
+    helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i-1)});
+
+    sat_constraint_clauses.push_back(new_clause1);
+    sat_constraint_clauses.push_back(new_clause2);
+
+    return helper;
+}
+
+// Returns a variable fixed to the given constant. Outside of the proof
+// each distinct constant is encoded only once and then shared by all
+// constraints that use it
+BasicVar* Encoder::get_constant_var(const BasicLiteralExpr& val, CNF& cnf_clauses){
+
+    vector<int> key;
+    if(holds_alternative<int>(val))
+        key = {0, get<int>(val)};
+    else if(holds_alternative<bool>(val))
+        key = {1, get<bool>(val) ? 1 : 0};
+    else {
+        key = {2};
+        auto set_vals = get<SetLiteral*>(val);
+        if(holds_alternative<SetSetLiteral*>(*set_vals)){
+            auto elems = get<SetSetLiteral*>(*set_vals)->elems;
+            key.insert(key.end(), elems->begin(), elems->end());
+        } else {
+            auto range = get<SetRangeLiteral*>(*set_vals);
+            for(int i = range->left; i <= range->right; i++)
+                key.push_back(i);
+        }
+    }
+
+    if(auto cached = find_cached(&Encoder::constant_vars, key))
+        return *cached;
+
+    BasicVar* var;
+    if(key[0] == 0){
+        var = encode_int_range_helper_variable(key[1], key[1], cnf_clauses);
+    } else {
+        int sub_id = next_var_id++;
+        BasicVarType* var_type;
+        if(key[0] == 1){
+            var_type = new BasicVarType(BasicParType::BOOL);
+            cnf_clauses.push_back({make_literal(LiteralType::BOOL_VARIABLE, sub_id, key[1] == 1, 0)});
+        } else {
+            auto elems = new vector<int>(key.begin() + 1, key.end());
+            var_type = new BasicVarType(new SetVarType(elems));
+            for(auto elem : *elems)
+                cnf_clauses.push_back({make_literal(LiteralType::SET_ELEM, sub_id, true, elem)});
         }
+
+        var = new BasicVar(var_type, new string("sub_" + to_string(sub_id)), true);
+        var->id = sub_id;
+        helper_vars.push_back(var);
     }
 
+    constant_vars[key] = var;
+    return var;
 }
 
+// Encodes a parameter used in place of a variable. Outside of the proof
+// the variable is memoised per parameter
 BasicVar* Encoder::encode_param_as_var(Parameter& param, CNF& cnf_clauses){
     
     auto val = param.value;
+    if(!export_proof){
+        if(auto cached = find_cached(&Encoder::param_vars, &param))
+            return *cached;
+        return param_vars[&param] = get_constant_var(*get<BasicLiteralExpr*>(*val), cnf_clauses);
+    }
+
     auto type = get<BasicParType>(*param.type);
     if(type == BasicParType::INT){
         int int_val = get<int>(*get<BasicLiteralExpr*>(*val));
@@ -3812,7 +5985,9 @@ BasicVar* Encoder::encode_param_as_var(Parameter& param, CNF& cnf_clauses){
             if(bv_right < (*elems)[(*elems).size()-1])
                 bv_right = (*elems)[(*elems).size()-1];
 
-            trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec \n"; 
+            trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec ";
+            trivial_encoding_vars.mark();
+            trivial_encoding_vars << "\n";
         }
 
         return set_var;
@@ -3831,11 +6006,13 @@ BasicVar* Encoder::get_var(Constraint& constr, int ind, CNF& cnf_clauses){
         if(variable_map.find(*tmp3) != variable_map.end())
             return get<BasicVar*>(*variable_map[*tmp3]);
         else{
-            auto param = *parameter_map[*tmp3];
-            return encode_param_as_var(param, cnf_clauses);
+            return encode_param_as_var(*parameter_map[*tmp3], cnf_clauses);
         }
     } else {
         auto type = get<BasicLiteralExpr*>(*tmp2);
+        if(!export_proof)
+            return get_constant_var(*type, cnf_clauses);
+
         if(holds_alternative<int>(*type)){
             int int_val = get<int>(*type);
             return encode_int_range_helper_variable(int_val, int_val, cnf_clauses);
@@ -3914,7 +6091,9 @@ BasicVar* Encoder::get_var(Constraint& constr, int ind, CNF& cnf_clauses){
                 isBV = true;
 
 
-                trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec \n"; 
+                trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec ";
+                trivial_encoding_vars.mark();
+                trivial_encoding_vars << "\n";
             }
 
             return set_var;
@@ -3933,7 +6112,13 @@ ArrayLiteral* Encoder::get_array(Constraint& constr, int ind){
             auto tmp4 = get<ArrayVar*>(*variable_map[*tmp3]);
             return tmp4->value;
         } else if(parameter_map.find(*tmp3) != parameter_map.end()){
-            auto tmp4 = get<ParArrayLiteral*>(*parameter_map[*tmp3]->value);
+            // A parameter array is converted once and then reused
+            // by every constraint that refers to it
+            auto param = parameter_map[*tmp3];
+            if(auto cached = find_cached(&Encoder::param_arrays, param))
+                return *cached;
+
+            auto tmp4 = get<ParArrayLiteral*>(*param->value);
             auto tmp5 = tmp4->elems;
             ArrayLiteral* a = new ArrayLiteral();
             for(int i = 0; i < (int)tmp5->size(); i++){
@@ -3941,7 +6126,7 @@ ArrayLiteral* Encoder::get_array(Constraint& constr, int ind){
                 a->push_back(b);
             }
 
-            allocated_arrays.push_back(a);
+            param_arrays[param] = a;
             return a;
         } else {
             cerr << "Variable/parameter not in use\n";
@@ -4012,11 +6197,13 @@ BasicVar* Encoder::get_var_from_array(const ArrayLiteral& a, int ind){
         if(variable_map.find(*tmp3) != variable_map.end())
             return get<BasicVar*>(*variable_map[*tmp3]);
         else{
-            auto param = *parameter_map[*tmp3];
-            return encode_param_as_var(param, cnf_clauses);
+            return encode_param_as_var(*parameter_map[*tmp3], cnf_clauses);
         }
     } else {
         auto type = get<BasicLiteralExpr*>(*tmp2);
+        if(!export_proof)
+            return get_constant_var(*type, cnf_clauses);
+
         if(holds_alternative<int>(*type)){
             int int_val = get<int>(*type);
             return encode_int_range_helper_variable(int_val, int_val, cnf_clauses);
@@ -4067,51 +6254,246 @@ BasicVar* Encoder::get_var_from_array(const ArrayLiteral& a, int ind){
                 }
             }
 
-            int sub_id = next_var_id++;
-            auto var_type = new BasicVarType(new SetVarType(elems));
-            string* name = new string("sub_" + to_string(sub_id));
+            int sub_id = next_var_id++;
+            auto var_type = new BasicVarType(new SetVarType(elems));
+            string* name = new string("sub_" + to_string(sub_id));
+
+            auto set_var = new BasicVar(var_type, name, true);
+            set_var->id = sub_id;
+
+            for(auto elem : *elems){
+                cnf_clauses.push_back({make_literal(LiteralType::SET_ELEM, sub_id, true, elem)});
+
+                if(export_proof)
+                    sat_dom_clauses.push_back({make_literal(LiteralType::SET_ELEM, sub_id, true, elem)});
+            }
+
+            if(export_proof){
+                set_vars.push_back(set_var);
+
+                isBV = true;
+
+                if(bv_left > (*elems)[0])
+                    bv_left = (*elems)[0];
+
+                if(bv_right < (*elems)[(*elems).size()-1])
+                    bv_right = (*elems)[(*elems).size()-1];
+
+                trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec ";
+                trivial_encoding_vars.mark();
+                trivial_encoding_vars << "\n";
+            }            
+
+            return set_var;
+        }
+    }
+}
+
+// Gets the elements of a set variable
+vector<int>* Encoder::get_set_elems(const BasicVar& var){
+    return get<SetVarType*>(*var.type)->elems;
+}
+
+
+// Checks whether the expression is an int constant, either a literal
+// or a named int parameter, and stores its value in val
+bool Encoder::is_int_const(const BasicExpr& expr, int& val){
+    BasicLiteralExpr* lit;
+    if(holds_alternative<string*>(expr)){
+        auto name = get<string*>(expr);
+        if(variable_map.find(*name) != variable_map.end())
+            return false;
+
+        auto param = parameter_map.find(*name);
+        if(param == parameter_map.end() || !holds_alternative<BasicLiteralExpr*>(*param->second->value))
+            return false;
+        lit = get<BasicLiteralExpr*>(*param->second->value);
+    } else
+        lit = get<BasicLiteralExpr*>(expr);
+
+    if(!holds_alternative<int>(*lit))
+        return false;
+
+    val = get<int>(*lit);
+    return true;
+}
+
+// Restricts an int variable to the interval [lo, hi] using unit
+// clauses over its order literals
+void Encoder::encode_int_in_range(const BasicVar& x, long long lo, long long hi, CNF& cnf_clauses){
+    int left = get_left(&x);
+    int right = get_right(&x);
+
+    if(lo > hi || lo > right || hi < left){
+        declare_unsat(cnf_clauses);
+        return;
+    }
 
-            auto set_var = new BasicVar(var_type, name, true);
-            set_var->id = sub_id;
+    if(lo > left)
+        cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, false, lo - 1)});
+    if(hi < right)
+        cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, true, hi)});
+}
 
-            for(auto elem : *elems){
-                cnf_clauses.push_back({make_literal(LiteralType::SET_ELEM, sub_id, true, elem)});
+// Forbids a single value of an int variable
+void Encoder::encode_int_ne_const(const BasicVar& x, long long val, CNF& cnf_clauses){
+    if(val < get_left(&x) || val > get_right(&x))
+        return;
 
-                if(export_proof)
-                    sat_dom_clauses.push_back({make_literal(LiteralType::SET_ELEM, sub_id, true, elem)});
-            }
+    cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, true, val - 1),
+                           make_literal(LiteralType::ORDER, x.id, false, val)});
+}
 
-            if(export_proof){
-                set_vars.push_back(set_var);
+// Encodes int_le, int_lt, int_eq and int_ne with a constant operand, and
+// int_lin_* with constant terms, directly on the order literals of the
+// remaining variables. Returns false if the constraint is not of that form
+bool Encoder::encode_const_operand(Constraint& constr, CNF& cnf_clauses){
+    const string& name = *constr.name;
+
+    if(name == "int_le" || name == "int_lt" || name == "int_eq" || name == "int_ne"){
+        int a_val, b_val;
+        bool a_const = is_int_const(*get<BasicExpr*>(*(*constr.args)[0]), a_val);
+        bool b_const = is_int_const(*get<BasicExpr*>(*(*constr.args)[1]), b_val);
+        if(!a_const && !b_const)
+            return false;
+
+        if(a_const && b_const){
+            bool holds;
+            if(name == "int_le")
+                holds = a_val <= b_val;
+            else if(name == "int_lt")
+                holds = a_val < b_val;
+            else if(name == "int_eq")
+                holds = a_val == b_val;
+            else
+                holds = a_val != b_val;
 
-                isBV = true;
+            if(!holds)
+                declare_unsat(cnf_clauses);
+            return true;
+        }
 
-                if(bv_left > (*elems)[0])
-                    bv_left = (*elems)[0];
+        auto x = get_var(constr, a_const ? 1 : 0, cnf_clauses);
+        long long c = a_const ? a_val : b_val;
+        long long strict = name == "int_lt" ? 1 : 0;
 
-                if(bv_right < (*elems)[(*elems).size()-1])
-                    bv_right = (*elems)[(*elems).size()-1];
+        if(name == "int_eq")
+            encode_int_in_range(*x, c, c, cnf_clauses);
+        else if(name == "int_ne")
+            encode_int_ne_const(*x, c, cnf_clauses);
+        else if(b_const)
+            encode_int_in_range(*x, numeric_limits<long long>::min(), c - strict, cnf_clauses);
+        else
+            encode_int_in_range(*x, c + strict, numeric_limits<long long>::max(), cnf_clauses);
+        return true;
+    }
 
-                trivial_encoding_vars << "(declare-const " << *set_var->name << " (_ BitVec \n"; 
-            }            
+    if(name == "int_lin_le" || name == "int_lin_eq" || name == "int_lin_ne"){
+        auto coefs = get_array(constr, 0);
+        auto vars = get_array(constr, 1);
+        long long rest = get<int>(*get_const(constr, 2));
 
-            return set_var;
+        // Moves the constant terms to the right-hand side
+        ArrayLiteral var_coefs, var_terms;
+        for(int i = 0; i < (int)vars->size(); i++){
+            int coef = get_int_from_array(*coefs, i);
+            int val;
+            if(coef == 0)
+                continue;
+
+            if(is_int_const(*(*vars)[i], val))
+                rest -= (long long)coef * val;
+            else {
+                var_coefs.push_back((*coefs)[i]);
+                var_terms.push_back((*vars)[i]);
+            }
+        }
+
+        if(var_terms.size() > 1){
+            if(var_terms.size() == vars->size() || rest < numeric_limits<int>::min() || rest > numeric_limits<int>::max())
+                return false;
+
+            if(name == "int_lin_le")
+                encode_int_lin_le(var_coefs, var_terms, rest, cnf_clauses);
+            else if(name == "int_lin_eq")
+                encode_int_lin_eq(var_coefs, var_terms, rest, cnf_clauses);
+            else
+                encode_int_lin_ne(var_coefs, var_terms, rest, cnf_clauses);
+            return true;
+        }
+
+        if(var_terms.empty()){
+            bool holds;
+            if(name == "int_lin_le")
+                holds = 0 <= rest;
+            else if(name == "int_lin_eq")
+                holds = rest == 0;
+            else
+                holds = rest != 0;
+
+            if(!holds)
+                declare_unsat(cnf_clauses);
+            return true;
         }
+
+        // A single term a*x compared with rest
+        int a = get_int_from_array(var_coefs, 0);
+        auto x = get_var_from_array(var_terms, 0);
+        if(name == "int_lin_le"){
+            if(a > 0)
+                encode_int_in_range(*x, numeric_limits<long long>::min(), (long long)floor((double)rest/a), cnf_clauses);
+            else
+                encode_int_in_range(*x, (long long)ceil((double)rest/a), numeric_limits<long long>::max(), cnf_clauses);
+        } else if(name == "int_lin_eq"){
+            if(rest % a != 0)
+                declare_unsat(cnf_clauses);
+            else
+                encode_int_in_range(*x, rest / a, rest / a, cnf_clauses);
+        } else if(rest % a == 0)
+            encode_int_ne_const(*x, rest / a, cnf_clauses);
+        return true;
     }
-}
 
-// Gets the elements of a set variable
-vector<int>* Encoder::get_set_elems(const BasicVar& var){
-    return get<SetVarType*>(*var.type)->elems;
+    return false;
 }
 
-
 // Checks which constraint is in question and calls the
 // appropriate function to encode it
 void Encoder::encode_constraint(Constraint& constr, CNF& cnf_clauses) {
+
+    encode_constraint_clauses(constr, cnf_clauses);
+    write_constraint_clauses(cnf_clauses);
+}
+
+// Adds the clauses of a constraint to cnf_clauses without writing them
+void Encoder::encode_constraint_clauses(Constraint& constr, CNF& cnf_clauses) {
     
-    
-    if(*constr.name == "array_int_element"){
+    // A reified constraint whose result is only used positively is encoded
+    // as the matching half-reification, and one whose result is not used is dropped
+    const string& name = *constr.name;
+    if(name.size() > 5 && name.compare(name.size() - 5, 5, "_reif") == 0){
+        auto r_arg = *constr.args->back();
+        if(holds_alternative<BasicExpr*>(r_arg) && holds_alternative<string*>(*get<BasicExpr*>(r_arg))){
+            int polarity = get_reif_polarity(*get<string*>(*get<BasicExpr*>(r_arg)));
+            if(polarity == POLARITY_NONE)
+                return;
+
+            if(polarity == POLARITY_POS){
+                string imp_name = name.substr(0, name.size() - 5) + "_imp";
+                Constraint imp_constr(&imp_name, constr.args);
+                encode_constraint_clauses(imp_constr, cnf_clauses);
+                return;
+            }
+        }
+    }
+
+    auto xor_row = xor_row_of.find(&constr);
+    if(!export_proof && encode_const_operand(constr, cnf_clauses)){
+        // Constant operands need no helper variable outside of the proof
+    } else if(xor_row != xor_row_of.end()){
+        if(xor_row_first[xor_row->second] == &constr)
+            encode_xor_row(xor_row->second, cnf_clauses);
+    } else if(*constr.name == "array_int_element"){
         auto b = get_var(constr, 0, cnf_clauses);
         auto as = get_array(constr, 1);
         auto c = get_var(constr, 2, cnf_clauses);
@@ -4563,8 +6945,11 @@ void Encoder::encode_constraint(Constraint& constr, CNF& cnf_clauses) {
 
     // if(!helper_vars.empty())
     //     cleanup_helper_variables();
-    if(!allocated_arrays.empty())
-        cleanup_arrays();
+}
+
+// Writes the clauses of the last encoded constraint, together with
+// their part of the proof
+void Encoder::write_constraint_clauses(CNF& cnf_clauses) {
 
     if(file_type == DIMACS)
         write_clauses_to_dimacs_file(cnf_clauses);
@@ -4645,6 +7030,16 @@ bool Encoder::encode_primitive_comparison_plus(const BasicVar& a, const BasicVar
 // Reifies the temp_clauses to be equivalent to the boolean variable r
 void Encoder::reify(CNF& temp_clauses, const BasicVar& r, CNF& cnf_clauses){
     
+    // When r is used in one polarity only, one direction of the equivalence is enough
+    int polarity = get_reif_polarity(*r.name);
+    if(polarity == POLARITY_POS){
+        impify(temp_clauses, r, cnf_clauses);
+        return;
+    } else if(polarity == POLARITY_NEG){
+        converse_impify(temp_clauses, r, cnf_clauses);
+        return;
+    }
+
     Clause helpers;
 
     LiteralPtr not_r = make_literal(LiteralType::BOOL_VARIABLE, r.id, false, 0);
@@ -4794,6 +7189,27 @@ void Encoder::impify(CNF& temp_clauses, const BasicVar& r, CNF& cnf_clauses){
     }
 }
 
+// Encodes the temp_clauses to imply the boolean variable r: if r is false,
+// one of the clauses is falsified
+void Encoder::converse_impify(CNF& temp_clauses, const BasicVar& r, CNF& cnf_clauses){
+
+    Clause helpers = {make_literal(LiteralType::BOOL_VARIABLE, r.id, true, 0)};
+
+    for(auto& clause : temp_clauses){
+        if(clause.size() == 1){
+            helpers.push_back(negate_literal(clause[0]));
+            continue;
+        }
+
+        LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        for(auto& l : clause)
+            cnf_clauses.push_back({negate_literal(helper), negate_literal(l)});
+        helpers.push_back(helper);
+    }
+
+    cnf_clauses.push_back(helpers);
+}
+
 // Encodes a constraint of type as[b] = c, where as is an array of int parameters
 void Encoder::encode_array_int_element(const BasicVar& b, const ArrayLiteral& as, BasicVar& c, CNF& cnf_clauses){
 
@@ -4833,19 +7249,7 @@ void Encoder::encode_array_int_element(const BasicVar& b, const ArrayLiteral& as
         if(i < 1 || i > (int)as.size())
             continue;
         
-        LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
-        new_clause1 = { make_literal(LiteralType::ORDER, b.id, true, i), helper};
-        new_clause2 = { make_literal(LiteralType::ORDER, b.id, false, i-1), helper};
-        cnf_clauses.push_back(new_clause1);
-        cnf_clauses.push_back(new_clause2);
-
-        if(export_proof){
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i-1)});
-
-            sat_constraint_clauses.push_back(new_clause1);
-            sat_constraint_clauses.push_back(new_clause2);
-        }
+        LiteralPtr helper = encode_index_selector(b, i, cnf_clauses);
 
         int curr_elem = get_int_from_array(as, i-1);
         if(c_left > curr_elem || c_right < curr_elem){
@@ -4865,8 +7269,7 @@ void Encoder::encode_array_int_element(const BasicVar& b, const ArrayLiteral& as
             sat_constraint_clauses.push_back(new_clause2);
         }
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, helper->id, true, 0);
-        helpers.push_back(not_helper);
+        helpers.push_back(negate_literal(helper));
     }
     
     cnf_clauses.push_back(helpers);
@@ -5093,24 +7496,11 @@ void Encoder::encode_array_var_int_element(const BasicVar& b, const ArrayLiteral
 
     Clause helpers;
     CNF temp_clauses;   
-    Clause new_clause1, new_clause2;
     for(int i = b_left; i <= b_right; i++){
         if(i < 1 || i > (int)as.size())
             continue;
         
-        LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
-        new_clause1 = { make_literal(LiteralType::ORDER, b.id, true, i), helper};
-        new_clause2 = { make_literal(LiteralType::ORDER, b.id, false, i-1), helper};
-        cnf_clauses.push_back(new_clause1);
-        cnf_clauses.push_back(new_clause2);
-
-        if(export_proof){
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i-1)});
-
-            sat_constraint_clauses.push_back(new_clause1);
-            sat_constraint_clauses.push_back(new_clause2);
-        }
+        LiteralPtr helper = encode_index_selector(b, i, cnf_clauses);
 
         auto curr_elem = get_var_from_array(as, i-1);
 
@@ -5137,8 +7527,7 @@ void Encoder::encode_array_var_int_element(const BasicVar& b, const ArrayLiteral
             }
         }   
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, helper->id, true, 0);
-        helpers.push_back(not_helper);
+        helpers.push_back(negate_literal(helper));
 
         temp_clauses.clear();
     }
@@ -6031,13 +8420,12 @@ void Encoder::encode_int_lin_eq(const ArrayLiteral& coefs, const ArrayLiteral &v
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -6054,13 +8442,12 @@ void Encoder::encode_int_lin_eq(const ArrayLiteral& coefs, const ArrayLiteral &v
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -6230,13 +8617,12 @@ void Encoder::encode_int_lin_eq_reif(const ArrayLiteral& coefs, const ArrayLiter
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -6253,13 +8639,12 @@ void Encoder::encode_int_lin_eq_reif(const ArrayLiteral& coefs, const ArrayLiter
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -6428,13 +8813,12 @@ void Encoder::encode_int_lin_eq_imp(const ArrayLiteral& coefs, const ArrayLitera
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -6451,13 +8835,12 @@ void Encoder::encode_int_lin_eq_imp(const ArrayLiteral& coefs, const ArrayLitera
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -6600,13 +8983,12 @@ void Encoder::encode_int_lin_le(const ArrayLiteral& coefs, const ArrayLiteral &v
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -6623,13 +9005,12 @@ void Encoder::encode_int_lin_le(const ArrayLiteral& coefs, const ArrayLiteral &v
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -6800,13 +9181,12 @@ void Encoder::encode_int_lin_le_reif(const ArrayLiteral& coefs, const ArrayLiter
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -6823,13 +9203,12 @@ void Encoder::encode_int_lin_le_reif(const ArrayLiteral& coefs, const ArrayLiter
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -7004,13 +9383,12 @@ void Encoder::encode_int_lin_le_imp(const ArrayLiteral& coefs, const ArrayLitera
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -7027,13 +9405,12 @@ void Encoder::encode_int_lin_le_imp(const ArrayLiteral& coefs, const ArrayLitera
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -7143,58 +9520,35 @@ void Encoder::encode_int_lin_ne(const ArrayLiteral& coefs, const ArrayLiteral &v
     auto coef1 = get_int_from_array(coefs, 1);
 
 
+    // Every value of var0 rules out at most one value of var1, so the
+    // constraint is a set of binary clauses over their direct encodings
     if(vars.size() == 2){
-        CNF temp_clauses;
-
-        if(export_proof){
-            export_proof = false;
-            lin_le_2args(var0, coef0, var1, coef1, c - 1, temp_clauses);
-            export_proof = true;
-        } else {
-            lin_le_2args(var0, coef0, var1, coef1, c - 1, temp_clauses);
+        if(coef1 == 0){
+            swap(var0, var1);
+            swap(coef0, coef1);
         }
 
-        LiteralPtr not_helper1 = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
-        LiteralPtr yes_helper1 = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
-
-        for(auto c : temp_clauses){
-            if(export_proof)
-                helper_map[not_helper1->id].push_back(c);
-
-            c.push_back(not_helper1);
-            cnf_clauses.push_back(c);
-
-            if(export_proof)
-                sat_constraint_clauses.push_back(c);
+        // Both coefficients are 0, so the constraint is 0 != c
+        if(coef1 == 0){
+            if(c == 0)
+                declare_unsat(cnf_clauses);
+            return;
         }
 
-        temp_clauses.clear();
-
-        if(export_proof){
-            export_proof = false;
-            lin_le_2args(var0, -coef0, var1, -coef1, -(c + 1), temp_clauses);
-            export_proof = true;
-        } else {
-            lin_le_2args(var0, -coef0, var1, -coef1, -(c + 1), temp_clauses);
-        }
-        LiteralPtr not_helper2 = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
-        LiteralPtr yes_helper2 = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        int left1 = get_left(&var1);
+        int right1 = get_right(&var1);
 
-        for(auto c : temp_clauses){
-            if(export_proof)
-                helper_map[not_helper2->id].push_back(c);
+        for(int i = get_left(&var0); i <= get_right(&var0); i++){
+            int rest = c - coef0*i;
+            if(rest % coef1 != 0 || rest / coef1 < left1 || rest / coef1 > right1)
+                continue;
 
-            c.push_back(not_helper2);
-            cnf_clauses.push_back(c);
+            Clause new_clause = {get_direct_literal(var0, i, false, cnf_clauses),
+                                 get_direct_literal(var1, rest / coef1, false, cnf_clauses)};
+            cnf_clauses.push_back(new_clause);
 
             if(export_proof)
-                sat_constraint_clauses.push_back(c);
-        }
-
-        cnf_clauses.push_back({yes_helper1, yes_helper2});
-        if(export_proof){
-            definition_clauses.push_back({yes_helper1, yes_helper2});
-            sat_constraint_clauses.push_back({yes_helper1, yes_helper2});
+                sat_constraint_clauses.push_back(new_clause);
         }
 
         return;
@@ -7272,13 +9626,12 @@ void Encoder::encode_int_lin_ne(const ArrayLiteral& coefs, const ArrayLiteral &v
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -7295,13 +9648,12 @@ void Encoder::encode_int_lin_ne(const ArrayLiteral& coefs, const ArrayLiteral &v
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -7538,13 +9890,12 @@ void Encoder::encode_int_lin_ne_reif(const ArrayLiteral& coefs, const ArrayLiter
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -7561,13 +9912,12 @@ void Encoder::encode_int_lin_ne_reif(const ArrayLiteral& coefs, const ArrayLiter
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -7781,13 +10131,12 @@ void Encoder::encode_int_lin_ne_imp(const ArrayLiteral& coefs, const ArrayLitera
 
     BasicVar *sub_var;
 
-    if(encoded_substitutions.find({var0.id, coef0, var1.id, coef1}) == 
-       encoded_substitutions.end()){
+    if(find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1}) == nullptr){
         sub_var = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
         encoded_substitutions[{var0.id, coef0, var1.id, coef1}] = sub_var;
         encode_substitution(*sub_var, var0, coef0, var1, coef1, cnf_clauses);
     } else {
-        sub_var = encoded_substitutions[{var0.id, coef0, var1.id, coef1}];
+        sub_var = *find_cached(&Encoder::encoded_substitutions, {var0.id, coef0, var1.id, coef1});
     }
 
     BasicVar *sub_var1;
@@ -7804,13 +10153,12 @@ void Encoder::encode_int_lin_ne_imp(const ArrayLiteral& coefs, const ArrayLitera
         upper_bound = upper_bound1 + upper_bound2;
 
 
-        if(encoded_substitutions.find({sub_var->id, 1, var_i.id, coef_i}) == 
-       encoded_substitutions.end()){
+        if(find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i}) == nullptr){
             sub_var1 = encode_int_range_helper_variable(lower_bound, upper_bound, cnf_clauses, true);
             encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}] = sub_var1;
             encode_substitution(*sub_var1, *sub_var, 1, var_i, coef_i, cnf_clauses);
         } else {
-            sub_var1 = encoded_substitutions[{sub_var->id, 1, var_i.id, coef_i}];
+            sub_var1 = *find_cached(&Encoder::encoded_substitutions, {sub_var->id, 1, var_i.id, coef_i});
         }
 
         sub_var = sub_var1;
@@ -8693,19 +11041,15 @@ void Encoder::encode_int_pow(const BasicVar& a, const BasicVar& b, const BasicVa
         cnf_clauses.push_back({make_literal(LiteralType::ORDER, b.id, false, -1)});
     }
 
-    encode_direct(a, cnf_clauses);
-    encode_direct(b, cnf_clauses);
-    encode_direct(c, cnf_clauses);
-
     Clause helpers;
     for(int i = a_left; i <= a_right; i++)
         for(int j = b_left; j <= b_right; j++){
             if(pow(i, j) >= c_left && pow(i, j) <= c_right){
                 LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
                 helpers.push_back(make_literal(LiteralType::HELPER, helper->id, true, 0));
-                Clause new_clause1 = {helper, make_literal(LiteralType::DIRECT, a.id, true, i)};
-                Clause new_clause2 = {helper, make_literal(LiteralType::DIRECT, b.id, true, j)};
-                Clause new_clause3 = {helper, make_literal(LiteralType::DIRECT, c.id, true, pow(i, j))};
+                Clause new_clause1 = {helper, get_direct_literal(a, i, true, cnf_clauses)};
+                Clause new_clause2 = {helper, get_direct_literal(b, j, true, cnf_clauses)};
+                Clause new_clause3 = {helper, get_direct_literal(c, pow(i, j), true, cnf_clauses)};
                 cnf_clauses.push_back(new_clause1);
                 cnf_clauses.push_back(new_clause2);
                 cnf_clauses.push_back(new_clause3);
@@ -8804,6 +11148,34 @@ void Encoder::encode_int_times(const BasicVar& a, const BasicVar& b, const Basic
     int c_left = get_left(&c);
     int c_right = get_right(&c);
 
+    // The binary multiplier introduces helper literals which have no
+    // definition in the proof, so it is only used when no proof is exported
+    TimesEncoding encoding = options.times_encoding;
+    if(encoding == TIMES_AUTO){
+        encoding = TIMES_ORDER;
+        double best_size = estimate_int_times_size(a, b, c, TIMES_ORDER);
+        for(auto candidate : {TIMES_TABLE, TIMES_BINARY}){
+            if(candidate == TIMES_BINARY && proof_requested)
+                continue;
+
+            double size = estimate_int_times_size(a, b, c, candidate);
+            if(size < best_size){
+                best_size = size;
+                encoding = candidate;
+            }
+        }
+    } else if(encoding == TIMES_BINARY && proof_requested){
+        encoding = TIMES_TABLE;
+    }
+
+    if(encoding == TIMES_TABLE){
+        encode_int_times_table(a, b, c, cnf_clauses);
+        return;
+    } else if(encoding == TIMES_BINARY){
+        encode_int_times_binary(a, b, c, cnf_clauses);
+        return;
+    }
+
     if(a_left >= 0 && b_left >= 0 && c_left >= 0){
 
         encode_int_times_nonnegative(a, b, c, cnf_clauses);
@@ -8863,15 +11235,314 @@ void Encoder::encode_int_times(const BasicVar& a, const BasicVar& b, const Basic
                         new_clause.push_back(make_literal(LiteralType::ORDER, c.id, false, curr_min - 1));                        
                     }
 
-                    cnf_clauses.push_back(new_clause);
+                    cnf_clauses.push_back(new_clause);
+
+                    if(export_proof)
+                        sat_constraint_clauses.push_back(new_clause);
+                }
+            }
+        } 
+    }
+
+}
+
+// Gets the number of bits needed to represent all values in [left, right],
+// in two's complement if is_signed is set
+int get_bit_width(long long left, long long right, bool is_signed){
+    int width = 1;
+    if(is_signed){
+        while(left < -(1LL << (width - 1)) || right > (1LL << (width - 1)) - 1)
+            width++;
+    } else {
+        while(right > (1LL << width) - 1)
+            width++;
+    }
+    return width;
+}
+
+// Estimates the number of clauses the given encoding of a * b = c produces
+double Encoder::estimate_int_times_size(const BasicVar& a, const BasicVar& b, const BasicVar& c, TimesEncoding encoding){
+
+    double a_left = get_left(&a), a_right = get_right(&a);
+    double b_left = get_left(&b), b_right = get_right(&b);
+    double c_left = get_left(&c), c_right = get_right(&c);
+    double a_size = a_right - a_left + 1;
+    double b_size = b_right - b_left + 1;
+
+    if(encoding == TIMES_ORDER){
+        if(a_left >= 0 && b_left >= 0 && c_left >= 0)
+            return 2*a_size*b_size;
+        else
+            return 2*(a_size*(a_size + 1)/2)*(b_size*(b_size + 1)/2);
+    } else if(encoding == TIMES_TABLE){
+        return 3*(a_size + b_size) + 2*a_size*b_size;
+    }
+
+    double products[] = {a_left*b_left, a_left*b_right, a_right*b_left, a_right*b_right};
+    double p_left = *min_element(products, products + 4);
+    double p_right = *max_element(products, products + 4);
+    bool is_signed = p_left < 0 || a_left < 0 || b_left < 0;
+
+    int a_width = get_bit_width(a_left, a_right, is_signed);
+    int b_width = get_bit_width(b_left, b_right, is_signed);
+    int width = get_bit_width(p_left, p_right, is_signed);
+    double c_size = max(0.0, min(c_right, p_right) - max(c_left, p_left) + 1);
+
+    // Each bit of a log encoding changes value about size/2^k times
+    double channel = 2*(a_size + b_size + c_size) + 2*(a_width + b_width + width);
+
+    // Every partial product bit costs an and gate and roughly one full adder
+    double partial_products = 0;
+    for(int i = 0; i < width; i++)
+        if(is_signed || i < b_width)
+            partial_products += is_signed ? width - i : min(a_width, width - i);
+
+    return channel + 17*partial_products;
+}
+
+// Encodes a constraint of type a * b = c as a product table over
+// the direct encodings of a and b
+void Encoder::encode_int_times_table(const BasicVar& a, const BasicVar& b, const BasicVar& c, CNF& cnf_clauses){
+
+    int a_left = get_left(&a);
+    int a_right = get_right(&a);
+    int b_left = get_left(&b);
+    int b_right = get_right(&b);
+    int c_left = get_left(&c);
+    int c_right = get_right(&c);
+
+    // Adds the clauses (premise -> c = product) 
+    auto encode_product = [&](const Clause& premise, long long product){
+        Clause new_clause = premise;
+        if(product < c_left || product > c_right){
+            cnf_clauses.push_back(new_clause);
+            if(export_proof)
+                sat_constraint_clauses.push_back(new_clause);
+            return;
+        }
+
+        if(product < c_right){
+            new_clause.push_back(make_literal(LiteralType::ORDER, c.id, true, product));
+            cnf_clauses.push_back(new_clause);
+            if(export_proof)
+                sat_constraint_clauses.push_back(new_clause);
+            new_clause.pop_back();
+        }
+
+        if(product > c_left){
+            new_clause.push_back(make_literal(LiteralType::ORDER, c.id, false, product - 1));
+            cnf_clauses.push_back(new_clause);
+            if(export_proof)
+                sat_constraint_clauses.push_back(new_clause);
+        }
+    };
+
+    // A zero factor fixes the product regardless of the other factor
+    if(a_left <= 0 && a_right >= 0)
+        encode_product({get_direct_literal(a, 0, false, cnf_clauses)}, 0);
+    if(b_left <= 0 && b_right >= 0)
+        encode_product({get_direct_literal(b, 0, false, cnf_clauses)}, 0);
+
+    for(int i = a_left; i <= a_right; i++){
+        if(i == 0)
+            continue;
+
+        for(int j = b_left; j <= b_right; j++){
+            if(j == 0)
+                continue;
+
+            encode_product({get_direct_literal(a, i, false, cnf_clauses),
+                            get_direct_literal(b, j, false, cnf_clauses)}, (long long)i*j);
+        }
+    }
+}
+
+// Binds the given bits to the two's complement representation of var,
+// for all values of var in [left, right]. A null bit stands for the constant 0
+void Encoder::encode_log_channel(const BasicVar& var, int left, int right, const vector<LiteralPtr>& bits, CNF& cnf_clauses){
+
+    int var_left = get_left(&var);
+    int var_right = get_right(&var);
+
+    for(int k = 0; k < (int)bits.size(); k++){
+        long long start = left;
+        while(start <= right){
+            bool bit = ((unsigned long long)start >> k) & 1;
+            long long end = min((long long)right, start | ((1LL << k) - 1));
+
+            if(bit || bits[k] != nullptr){
+                Clause new_clause;
+                if(start > var_left)
+                    new_clause.push_back(make_literal(LiteralType::ORDER, var.id, true, start - 1));
+                if(end < var_right)
+                    new_clause.push_back(make_literal(LiteralType::ORDER, var.id, false, end));
+                if(bits[k] != nullptr)
+                    new_clause.push_back(bit ? bits[k] : negate_literal(bits[k]));
+
+                cnf_clauses.push_back(new_clause);
+            }
+
+            start = end + 1;
+        }
+    }
+}
+
+// Gets the bits of the log encoding of var with the given width,
+// creating and channelling them to the order encoding on first use
+vector<LiteralPtr> Encoder::encode_log_bits(const BasicVar& var, int width, CNF& cnf_clauses){
+
+    if(auto cached = find_cached(&Encoder::log_bits_map, {var.id, width}))
+        return *cached;
+
+    vector<LiteralPtr> bits;
+    for(int k = 0; k < width; k++)
+        bits.push_back(make_literal(LiteralType::HELPER, next_helper_id++, true, 0));
+
+    encode_log_channel(var, get_left(&var), get_right(&var), bits, cnf_clauses);
+
+    log_bits_map[{var.id, width}] = bits;
+    return bits;
+}
+
+// Encodes a helper literal equivalent to x and y. A null input stands
+// for the constant 0
+LiteralPtr Encoder::encode_and_gate(const LiteralPtr& x, const LiteralPtr& y, CNF& cnf_clauses){
+
+    if(x == nullptr || y == nullptr)
+        return nullptr;
+
+    LiteralPtr h = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+    cnf_clauses.push_back({negate_literal(h), x});
+    cnf_clauses.push_back({negate_literal(h), y});
+    cnf_clauses.push_back({h, negate_literal(x), negate_literal(y)});
+
+    return h;
+}
+
+// Encodes the sum and carry bits of x + y + z. Null inputs and
+// outputs stand for the constant 0
+pair<LiteralPtr, LiteralPtr> Encoder::encode_full_adder(const LiteralPtr& x, const LiteralPtr& y, const LiteralPtr& z, CNF& cnf_clauses){
+
+    vector<LiteralPtr> inputs;
+    for(auto l : {x, y, z})
+        if(l != nullptr)
+            inputs.push_back(l);
+
+    if(inputs.empty())
+        return {nullptr, nullptr};
+    else if(inputs.size() == 1)
+        return {inputs[0], nullptr};
+
+    LiteralPtr sum = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+    LiteralPtr carry = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+    int n = inputs.size();
+
+    // sum is the parity of the inputs: forbid every assignment where it is not
+    for(int mask = 0; mask < (1 << n); mask++){
+        bool parity = __builtin_popcount(mask) % 2;
+        Clause new_clause;
+        for(int i = 0; i < n; i++)
+            new_clause.push_back((mask >> i) & 1 ? negate_literal(inputs[i]) : inputs[i]);
+        new_clause.push_back(parity ? sum : negate_literal(sum));
+        cnf_clauses.push_back(new_clause);
+    }
+
+    // carry is set iff at least two inputs are set
+    for(int i = 0; i < n; i++)
+        for(int j = i + 1; j < n; j++)
+            cnf_clauses.push_back({negate_literal(inputs[i]), negate_literal(inputs[j]), carry});
+
+    for(int i = 0; i < n; i++){
+        Clause new_clause = {negate_literal(carry)};
+        for(int j = 0; j < n; j++)
+            if(j != i)
+                new_clause.push_back(inputs[j]);
+        cnf_clauses.push_back(new_clause);
+    }
+
+    return {sum, carry};
+}
+
+// Encodes a constraint of type a * b = c by a shift-and-add multiplier
+// over the log encodings of a and b, whose result is channelled to c
+void Encoder::encode_int_times_binary(const BasicVar& a, const BasicVar& b, const BasicVar& c, CNF& cnf_clauses){
+
+    long long a_left = get_left(&a);
+    long long a_right = get_right(&a);
+    long long b_left = get_left(&b);
+    long long b_right = get_right(&b);
+    int c_left = get_left(&c);
+    int c_right = get_right(&c);
+
+    long long p_left = min({a_left*b_left, a_left*b_right, a_right*b_left, a_right*b_right});
+    long long p_right = max({a_left*b_left, a_left*b_right, a_right*b_left, a_right*b_right});
+
+    if(p_left > c_right || p_right < c_left){
+        declare_unsat(cnf_clauses);
+        return;
+    }
+
+    // Values of c which no product can reach are ruled out directly
+    int left = max((long long)c_left, p_left);
+    int right = min((long long)c_right, p_right);
+    if(left > c_left)
+        cnf_clauses.push_back({make_literal(LiteralType::ORDER, c.id, false, left - 1)});
+    if(right < c_right)
+        cnf_clauses.push_back({make_literal(LiteralType::ORDER, c.id, true, right)});
+
+    bool is_signed = p_left < 0 || a_left < 0 || b_left < 0;
+    int a_width = get_bit_width(a_left, a_right, is_signed);
+    int b_width = get_bit_width(b_left, b_right, is_signed);
+    int width = get_bit_width(p_left, p_right, is_signed);
+
+    vector<LiteralPtr> a_bits = encode_log_bits(a, a_width, cnf_clauses);
+    vector<LiteralPtr> b_bits = encode_log_bits(b, b_width, cnf_clauses);
+
+    // Operands are sign extended to the width of the product, which
+    // makes the product modulo 2^width exact
+    auto extend = [&](const vector<LiteralPtr>& bits, int k) -> LiteralPtr {
+        if(k < (int)bits.size())
+            return bits[k];
+        return is_signed ? bits.back() : nullptr;
+    };
+
+    vector<vector<LiteralPtr>> columns(width);
+    for(int i = 0; i < width; i++){
+        LiteralPtr b_bit = extend(b_bits, i);
+        if(b_bit == nullptr)
+            continue;
 
-                    if(export_proof)
-                        sat_constraint_clauses.push_back(new_clause);
-                }
+        for(int k = 0; i + k < width; k++){
+            LiteralPtr partial = encode_and_gate(b_bit, extend(a_bits, k), cnf_clauses);
+            if(partial != nullptr)
+                columns[i + k].push_back(partial);
+        }
+    }
+
+    vector<LiteralPtr> result(width);
+    for(int j = 0; j < width; j++){
+        auto& column = columns[j];
+        while(column.size() > 1){
+            LiteralPtr x = column.back();
+            column.pop_back();
+            LiteralPtr y = column.back();
+            column.pop_back();
+            LiteralPtr z = nullptr;
+            if(!column.empty()){
+                z = column.back();
+                column.pop_back();
             }
-        } 
+
+            auto [sum, carry] = encode_full_adder(x, y, z, cnf_clauses);
+            column.insert(column.begin(), sum);
+            if(carry != nullptr && j + 1 < width)
+                columns[j + 1].push_back(carry);
+        }
+
+        result[j] = column.empty() ? nullptr : column[0];
     }
 
+    encode_log_channel(c, left, right, result, cnf_clauses);
 }
 
 // Encodes a constraint of type x ∈ S1
@@ -9032,19 +11703,7 @@ void Encoder::encode_array_bool_element(const BasicVar& b, const ArrayLiteral& a
         if(i < 1 || i > (int)as.size())
             continue;
         
-        LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
-        new_clause1 = { make_literal(LiteralType::ORDER, b.id, true, i), helper};
-        new_clause2 = { make_literal(LiteralType::ORDER, b.id, false, i-1), helper};
-        cnf_clauses.push_back(new_clause1);
-        cnf_clauses.push_back(new_clause2);
-
-        if(export_proof){
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i-1)});
-
-            sat_constraint_clauses.push_back(new_clause1);
-            sat_constraint_clauses.push_back(new_clause2);
-        }
+        LiteralPtr helper = encode_index_selector(b, i, cnf_clauses);
 
         bool curr_elem = get_bool_from_array(as, i-1);
 
@@ -9057,8 +11716,7 @@ void Encoder::encode_array_bool_element(const BasicVar& b, const ArrayLiteral& a
             sat_constraint_clauses.push_back(new_clause1);
         }       
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, helper->id, true, 0);
-        helpers.push_back(not_helper);
+        helpers.push_back(negate_literal(helper));
     }
     
     cnf_clauses.push_back(helpers);
@@ -9139,6 +11797,14 @@ void Encoder::encode_array_bool_xor(const ArrayLiteral& as, CNF& cnf_clauses){
         
     }    
 
+    if(!proof_requested){
+        Clause lits;
+        for(int i = 0; i < (int)as.size(); i++)
+            lits.push_back(make_literal(LiteralType::BOOL_VARIABLE, get_var_from_array(as, i)->id, true, 0));
+        encode_xor(lits, true, cnf_clauses);
+        return;
+    }
+
     auto var0 = get_var_from_array(as, 0);
     auto var1 = get_var_from_array(as, 1);
     if(as.size() == 2){
@@ -9217,6 +11883,62 @@ void Encoder::encode_array_bool_xor(const ArrayLiteral& as, CNF& cnf_clauses){
 
 }
 
+// Encodes a constraint of type xor i lits[i] = parity. Solvers which
+// support them get a native XOR clause, otherwise the literals are cut
+// into chunks of xor_chunk literals, each encoded directly in CNF
+void Encoder::encode_xor(Clause lits, bool parity, CNF& cnf_clauses){
+
+    if(lits.empty()){
+        if(parity)
+            declare_unsat(cnf_clauses);
+        return;
+    }
+
+    if(lits.size() > 1 && options.xor_clauses && file_type == DIMACS && !proof_requested){
+        if(!parity)
+            lits[0] = negate_literal(lits[0]);
+        xor_clauses.push_back(lits);
+        return;
+    }
+
+    int chunk = max(options.xor_chunk, 3);
+    int start = 0;
+    while((int)lits.size() - start > chunk){
+        LiteralPtr h = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        Clause link(lits.begin() + start, lits.begin() + start + chunk - 1);
+        link.push_back(h);
+        encode_xor(link, false, cnf_clauses);
+
+        start += chunk - 1;
+        lits.push_back(h);
+    }
+    lits.erase(lits.begin(), lits.begin() + start);
+
+    // Forbids every assignment of the literals with the wrong parity
+    int n = lits.size();
+    for(int mask = 0; mask < (1 << n); mask++){
+        if((__builtin_popcount(mask) % 2 == 1) == parity)
+            continue;
+
+        Clause new_clause;
+        for(int i = 0; i < n; i++)
+            new_clause.push_back((mask >> i) & 1 ? negate_literal(lits[i]) : lits[i]);
+        cnf_clauses.push_back(new_clause);
+    }
+}
+
+// Encodes a parity row found by detect_xor_chains
+void Encoder::encode_xor_row(int row, CNF& cnf_clauses){
+
+    Clause lits;
+    for(auto& name : xor_rows[row].first){
+        auto var = get<BasicVar*>(*variable_map[name]);
+        lits.push_back(make_literal(LiteralType::BOOL_VARIABLE, var->id, true, 0));
+    }
+
+    encode_xor(lits, xor_rows[row].second, cnf_clauses);
+}
+
 // Encodes a constraint of type as[b] = c, where as is an array of bool var parameters
 void Encoder::encode_array_var_bool_element(const BasicVar& b, const ArrayLiteral& as, BasicVar& c, CNF& cnf_clauses){
 
@@ -9252,19 +11974,7 @@ void Encoder::encode_array_var_bool_element(const BasicVar& b, const ArrayLitera
         if(i < 1 || i > (int)as.size())
             continue;
         
-        LiteralPtr helper = make_literal(LiteralType::HELPER, next_helper_id++, false, 0);
-        new_clause1 = { make_literal(LiteralType::ORDER, b.id, true, i), helper};
-        new_clause2 = { make_literal(LiteralType::ORDER, b.id, false, i-1), helper};
-        cnf_clauses.push_back(new_clause1);
-        cnf_clauses.push_back(new_clause2);
-
-        if(export_proof){
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i-1)});
-
-            sat_constraint_clauses.push_back(new_clause1);
-            sat_constraint_clauses.push_back(new_clause2);
-        }
+        LiteralPtr helper = encode_index_selector(b, i, cnf_clauses);
 
         auto curr_elem = get_var_from_array(as, i-1);
 
@@ -9287,8 +11997,7 @@ void Encoder::encode_array_var_bool_element(const BasicVar& b, const ArrayLitera
             sat_constraint_clauses.push_back(new_clause2);
         }        
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, helper->id, true, 0);
-        helpers.push_back(not_helper);
+        helpers.push_back(negate_literal(helper));
     }
     
     cnf_clauses.push_back(helpers);
@@ -9692,22 +12401,18 @@ void Encoder::encode_bool_substitution(const BasicVar &x, const BasicVar &x1, in
     int x2_left = get_left(&x2);
     int x2_right = get_right(&x2);
 
-    encode_direct(x, cnf_clauses);
-    if(!holds_alternative<BasicParType>(*x1.type))
-        encode_direct(x1, cnf_clauses);
-
     //x = x1 + x2
     Clause helpers;
     for(int i = x_left; i <= x_right; i++){
         for(int j = x1_left; j <= x1_right; j++){
             for(int k = x2_left; k <= x2_right; k++){
                 if(j*coef1 + k*coef2 == i){
-                    LiteralPtr l_i = make_literal(LiteralType::DIRECT, x.id, true, i);
+                    LiteralPtr l_i = get_direct_literal(x, i, true, cnf_clauses);
                     LiteralPtr l_j;
                     if(holds_alternative<BasicParType>(*x1.type))
                         l_j = make_literal(LiteralType::BOOL_VARIABLE, x1.id, j == 0 ? false : true, 0);
                     else    
-                        l_j = make_literal(LiteralType::DIRECT, x1.id, true, j);
+                        l_j = get_direct_literal(x1, j, true, cnf_clauses);
                     LiteralPtr l_k = make_literal(LiteralType::BOOL_VARIABLE, x2.id, k == 0 ? false : true, 0);
 
                     LiteralPtr not_helper = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
@@ -9813,6 +12518,22 @@ void Encoder::encode_bool_lin_eq(const ArrayLiteral& coefs, const ArrayLiteral &
         return;
     }
 
+    // The pseudo-Boolean encodings introduce helper literals which have
+    // no definition in the proof, so they are only used when no proof is exported
+    if(!proof_requested){
+        PbTerms terms;
+        for(int i = 0; i < (int)vars.size(); i++){
+            auto var = get_var_from_array(vars, i);
+            terms.push_back({get_int_from_array(coefs, i), make_literal(LiteralType::BOOL_VARIABLE, var->id, true, 0)});
+        }
+        encode_pb_le(terms, c, cnf_clauses);
+
+        for(auto& term : terms)
+            term.first = -term.first;
+        encode_pb_le(terms, -c, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         constraints2step2 << "(and\n";
 
@@ -9958,6 +12679,18 @@ void Encoder::encode_bool_lin_le(const ArrayLiteral& coefs, const ArrayLiteral &
         return;
     }
 
+    // The pseudo-Boolean encodings introduce helper literals which have
+    // no definition in the proof, so they are only used when no proof is exported
+    if(!proof_requested){
+        PbTerms terms;
+        for(int i = 0; i < (int)vars.size(); i++){
+            auto var = get_var_from_array(vars, i);
+            terms.push_back({get_int_from_array(coefs, i), make_literal(LiteralType::BOOL_VARIABLE, var->id, true, 0)});
+        }
+        encode_pb_le(terms, c, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         constraints2step2 << "(and\n";
 
@@ -10022,6 +12755,370 @@ void Encoder::encode_bool_lin_le(const ArrayLiteral& coefs, const ArrayLiteral &
 
 }
 
+// Encodes a pseudo-Boolean constraint w1*l1 + ... + wn*ln <= k. The
+// weights are first made positive by replacing w*l with |w|*~l + w
+void Encoder::encode_pb_le(const PbTerms& terms, long long k, CNF& cnf_clauses){
+
+    PbTerms normalized;
+    for(auto& [w, l] : terms){
+        if(w < 0){
+            k -= w;
+            normalized.push_back({-w, negate_literal(l)});
+        } else if(w > 0) {
+            normalized.push_back({w, l});
+        }
+    }
+
+    if(k < 0){
+        declare_unsat(cnf_clauses);
+        return;
+    }
+
+    // A term heavier than the bound can never be set
+    PbTerms remaining;
+    long long sum = 0;
+    for(auto& [w, l] : normalized){
+        if(w > k){
+            cnf_clauses.push_back({negate_literal(l)});
+        } else {
+            remaining.push_back({w, l});
+            sum += w;
+        }
+    }
+
+    if(sum <= k)
+        return;
+
+    int g = 0;
+    for(auto& term : remaining)
+        g = __gcd(g, term.first);
+    for(auto& term : remaining)
+        term.first /= g;
+    k /= g;
+
+    // Heavy terms first keep the prefix sums and the BDD levels small
+    stable_sort(remaining.begin(), remaining.end(), [](const pair<int, LiteralPtr>& x, const pair<int, LiteralPtr>& y){
+        return x.first > y.first;
+    });
+
+    PbEncoding encoding = options.pb_encoding;
+    if(encoding == PB_AUTO){
+        encoding = PB_SEQUENTIAL;
+        double best_size = estimate_pb_size(remaining, k, PB_SEQUENTIAL);
+        for(auto candidate : {PB_TOTALIZER, PB_SORTER, PB_BDD}){
+            double size = estimate_pb_size(remaining, k, candidate);
+            if(size < best_size){
+                best_size = size;
+                encoding = candidate;
+            }
+        }
+    }
+
+    if(encoding == PB_SEQUENTIAL){
+        encode_pb_sequential(remaining, k, cnf_clauses);
+    } else if(encoding == PB_TOTALIZER){
+        encode_pb_totalizer(remaining, 0, remaining.size(), k, true, cnf_clauses);
+    } else if(encoding == PB_SORTER){
+        encode_pb_sorter(remaining, k, cnf_clauses);
+    } else {
+        vector<long long> suffix(remaining.size() + 1, 0);
+        for(int i = (int)remaining.size() - 1; i >= 0; i--)
+            suffix[i] = suffix[i + 1] + remaining[i].first;
+
+        vector<map<long long, PbBddNode>> memo(remaining.size());
+        PbBddNode root = encode_pb_bdd(remaining, suffix, 0, k, memo, cnf_clauses);
+        cnf_clauses.push_back({root.lit});
+    }
+}
+
+// Collects the distinct sums up to k of the terms in [left, right) as the
+// generalized totalizer does, adding the number of its clauses to size
+vector<long long> get_totalizer_sums(const PbTerms& terms, int left, int right, long long k, double& size){
+
+    if(right - left == 1)
+        return {terms[left].first};
+
+    int mid = (left + right) / 2;
+    vector<long long> a = get_totalizer_sums(terms, left, mid, k, size);
+    vector<long long> b = get_totalizer_sums(terms, mid, right, k, size);
+
+    set<long long> sums(a.begin(), a.end());
+    sums.insert(b.begin(), b.end());
+    for(auto x : a)
+        for(auto y : b)
+            if(x + y <= k)
+                sums.insert(x + y);
+
+    size += a.size() + b.size() + (double)a.size() * b.size();
+    return vector<long long>(sums.begin(), sums.end());
+}
+
+// Estimates the number of clauses of a normalized pseudo-Boolean constraint
+// whose weights are positive, at most k and sum up to more than k
+double Encoder::estimate_pb_size(const PbTerms& terms, long long k, PbEncoding encoding){
+
+    int n = terms.size();
+    long long sum = 0;
+    int min_weight = terms[0].first;
+    int max_weight = terms[0].first;
+    for(auto& term : terms){
+        sum += term.first;
+        min_weight = min(min_weight, term.first);
+        max_weight = max(max_weight, term.first);
+    }
+
+    double size = 0;
+    if(encoding == PB_SEQUENTIAL){
+        long long prefix = 0;
+        for(int i = 0; i < n; i++){
+            long long w = terms[i].first;
+            long long prev = min(k, prefix);
+            if(i < n - 1)
+                size += prev + w + max(0LL, min(prev, k - w));
+            if(k + 1 - w <= prev)
+                size++;
+            prefix += w;
+        }
+    } else if(encoding == PB_TOTALIZER){
+        get_totalizer_sums(terms, 0, n, k, size);
+    } else if(encoding == PB_SORTER){
+        // Weights are expanded to unary, so a wide coefficient spread
+        // makes the network grow with the weights instead of the terms
+        if(max_weight / min_weight > 4)
+            return INFINITY;
+
+        double levels = ceil(log2(min(sum, k + 1) + 1));
+        size = 3.0 * sum * (levels * (levels + 1) / 4 + 1);
+    } else if(encoding == PB_BDD){
+        // A level holds at most one node for each bound and for each
+        // path from the root, and at most one per distinct suffix sum
+        for(int i = 0; i < n; i++){
+            double nodes = k + 1;
+            if(i < 62)
+                nodes = min(nodes, pow(2.0, i));
+            if(n - i < 62)
+                nodes = min(nodes, pow(2.0, n - i) + 1);
+            size += 2 * nodes;
+        }
+    }
+
+    return size;
+}
+
+// Encodes a normalized pseudo-Boolean constraint by a sequential weight
+// counter, where s[i][j] holds if the first i + 1 terms sum up to at least j
+void Encoder::encode_pb_sequential(const PbTerms& terms, long long k, CNF& cnf_clauses){
+
+    int n = terms.size();
+    vector<LiteralPtr> prev;
+    long long prefix = 0;
+
+    for(int i = 0; i < n; i++){
+        auto [w, l] = terms[i];
+        long long prev_size = min(k, prefix);
+
+        if(k + 1 - w <= prev_size)
+            cnf_clauses.push_back({negate_literal(prev[k + 1 - w]), negate_literal(l)});
+
+        prefix += w;
+        if(i == n - 1)
+            break;
+
+        vector<LiteralPtr> curr(min(k, prefix) + 1);
+        for(int j = 1; j < (int)curr.size(); j++)
+            curr[j] = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+
+        for(int j = 1; j <= prev_size; j++)
+            cnf_clauses.push_back({negate_literal(prev[j]), curr[j]});
+        for(int j = 1; j <= w; j++)
+            cnf_clauses.push_back({negate_literal(l), curr[j]});
+        for(int j = 1; j <= prev_size && j + w <= k; j++)
+            cnf_clauses.push_back({negate_literal(prev[j]), negate_literal(l), curr[j + w]});
+
+        prev = curr;
+    }
+}
+
+// Encodes the terms in [left, right) by a generalized totalizer and returns
+// the literals of the node, one for each reachable sum up to k. The root
+// only forbids the combinations of its children which exceed k
+PbTerms Encoder::encode_pb_totalizer(const PbTerms& terms, int left, int right, long long k, bool is_root, CNF& cnf_clauses){
+
+    if(right - left == 1)
+        return {terms[left]};
+
+    int mid = (left + right) / 2;
+    PbTerms a = encode_pb_totalizer(terms, left, mid, k, false, cnf_clauses);
+    PbTerms b = encode_pb_totalizer(terms, mid, right, k, false, cnf_clauses);
+
+    map<long long, LiteralPtr> outputs;
+    if(!is_root){
+        for(auto& [x, l] : a)
+            outputs[x] = nullptr;
+        for(auto& [y, l] : b)
+            outputs[y] = nullptr;
+        for(auto& [x, lx] : a)
+            for(auto& [y, ly] : b)
+                if(x + y <= k)
+                    outputs[x + y] = nullptr;
+
+        for(auto& [value, l] : outputs)
+            l = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+
+        for(auto& [x, l] : a)
+            cnf_clauses.push_back({negate_literal(l), outputs[x]});
+        for(auto& [y, l] : b)
+            cnf_clauses.push_back({negate_literal(l), outputs[y]});
+    }
+
+    for(auto& [x, lx] : a){
+        for(auto& [y, ly] : b){
+            if(x + y > k)
+                cnf_clauses.push_back({negate_literal(lx), negate_literal(ly)});
+            else if(!is_root)
+                cnf_clauses.push_back({negate_literal(lx), negate_literal(ly), outputs[x + y]});
+        }
+    }
+
+    PbTerms result;
+    for(auto& [value, l] : outputs)
+        result.push_back({value, l});
+
+    return result;
+}
+
+// Encodes a normalized pseudo-Boolean constraint by sorting its terms,
+// each expanded to as many inputs as its weight, and forbidding the
+// output which counts k + 1 set inputs
+void Encoder::encode_pb_sorter(const PbTerms& terms, long long k, CNF& cnf_clauses){
+
+    vector<LiteralPtr> inputs;
+    for(auto& [w, l] : terms)
+        for(int i = 0; i < w; i++)
+            inputs.push_back(l);
+
+    vector<LiteralPtr> outputs = encode_sorter(inputs, k + 1, cnf_clauses);
+    cnf_clauses.push_back({negate_literal(outputs[k])});
+}
+
+// Encodes an odd-even merge sorting network whose outputs are in decreasing
+// order, keeping only the first m of them. The outputs are implied by the
+// inputs, which is the direction needed for upper bounds
+vector<LiteralPtr> Encoder::encode_sorter(const vector<LiteralPtr>& inputs, int m, CNF& cnf_clauses){
+
+    if(inputs.size() <= 1)
+        return inputs;
+
+    int mid = inputs.size() / 2;
+    vector<LiteralPtr> a = encode_sorter(vector<LiteralPtr>(inputs.begin(), inputs.begin() + mid), m, cnf_clauses);
+    vector<LiteralPtr> b = encode_sorter(vector<LiteralPtr>(inputs.begin() + mid, inputs.end()), m, cnf_clauses);
+
+    vector<LiteralPtr> outputs = encode_merger(a, b, cnf_clauses);
+    if((int)outputs.size() > m)
+        outputs.resize(m);
+
+    return outputs;
+}
+
+// Encodes Batcher's odd-even merge of two sequences sorted in decreasing order
+vector<LiteralPtr> Encoder::encode_merger(const vector<LiteralPtr>& a, const vector<LiteralPtr>& b, CNF& cnf_clauses){
+
+    if(a.empty())
+        return b;
+    if(b.empty())
+        return a;
+    if(a.size() == 1 && b.size() == 1){
+        auto [high, low] = encode_comparator(a[0], b[0], cnf_clauses);
+        return {high, low};
+    }
+
+    vector<LiteralPtr> a_even, a_odd, b_even, b_odd;
+    for(int i = 0; i < (int)a.size(); i++)
+        (i % 2 ? a_odd : a_even).push_back(a[i]);
+    for(int i = 0; i < (int)b.size(); i++)
+        (i % 2 ? b_odd : b_even).push_back(b[i]);
+
+    vector<LiteralPtr> d = encode_merger(a_even, b_even, cnf_clauses);
+    vector<LiteralPtr> e = encode_merger(a_odd, b_odd, cnf_clauses);
+
+    vector<LiteralPtr> outputs = {d[0]};
+    int i = 1;
+    for(; i < (int)d.size() && i - 1 < (int)e.size(); i++){
+        auto [high, low] = encode_comparator(d[i], e[i - 1], cnf_clauses);
+        outputs.push_back(high);
+        outputs.push_back(low);
+    }
+    for(int j = i; j < (int)d.size(); j++)
+        outputs.push_back(d[j]);
+    for(int j = i - 1; j < (int)e.size(); j++)
+        outputs.push_back(e[j]);
+
+    return outputs;
+}
+
+// Encodes the maximum and the minimum of x and y, as implied by x and y.
+// Null inputs and outputs stand for the constant 0
+pair<LiteralPtr, LiteralPtr> Encoder::encode_comparator(const LiteralPtr& x, const LiteralPtr& y, CNF& cnf_clauses){
+
+    if(x == nullptr)
+        return {y, nullptr};
+    if(y == nullptr)
+        return {x, nullptr};
+
+    LiteralPtr high = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+    LiteralPtr low = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+    cnf_clauses.push_back({negate_literal(x), high});
+    cnf_clauses.push_back({negate_literal(y), high});
+    cnf_clauses.push_back({negate_literal(x), negate_literal(y), low});
+
+    return {high, low};
+}
+
+// Encodes the node of the BDD for terms[i..] <= k, sharing nodes between
+// bounds with the same interval. The node literal implies the constraint
+PbBddNode Encoder::encode_pb_bdd(const PbTerms& terms, const vector<long long>& suffix, int i, long long k,
+                                 vector<map<long long, PbBddNode>>& memo, CNF& cnf_clauses){
+
+    const long long infinity = 1LL << 60;
+
+    if(k < 0)
+        return {-infinity, -1, nullptr, false};
+    if(k >= suffix[i])
+        return {suffix[i], infinity, nullptr, true};
+
+    auto it = memo[i].upper_bound(k);
+    if(it != memo[i].begin() && prev(it)->second.upper >= k)
+        return prev(it)->second;
+
+    auto [w, l] = terms[i];
+    PbBddNode low = encode_pb_bdd(terms, suffix, i + 1, k, memo, cnf_clauses);
+    PbBddNode high = encode_pb_bdd(terms, suffix, i + 1, k - w, memo, cnf_clauses);
+
+    PbBddNode node;
+    node.lower = max(low.lower, high.lower + w);
+    node.upper = min(low.upper, high.upper + w);
+
+    if(low.lit == high.lit && low.is_true == high.is_true){
+        node.lit = low.lit;
+        node.is_true = low.is_true;
+    } else {
+        node.lit = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        node.is_true = false;
+
+        // The branch where l is not set can not be false since k >= 0
+        if(!low.is_true)
+            cnf_clauses.push_back({negate_literal(node.lit), low.lit});
+
+        if(high.lit == nullptr && !high.is_true)
+            cnf_clauses.push_back({negate_literal(node.lit), negate_literal(l)});
+        else if(!high.is_true)
+            cnf_clauses.push_back({negate_literal(node.lit), negate_literal(l), high.lit});
+    }
+
+    memo[i][node.lower] = node;
+    return node;
+}
+
 // Encodes constraint of type a < b
 void Encoder::encode_bool_lt(const BasicVar &a, const BasicVar& b, CNF &cnf_clauses){
     
@@ -10251,7 +13348,9 @@ void Encoder::encode_array_set_element(const BasicVar& b, const ArrayLiteral& as
 
 
         string arr_name = "arr_" + to_string(next_array++);
-        trivial_encoding_vars << "(declare-fun " << arr_name << " (Int) (_ BitVec \n"; 
+        trivial_encoding_vars << "(declare-fun " << arr_name << " (Int) (_ BitVec ";
+        trivial_encoding_vars.mark();
+        trivial_encoding_vars << "\n";
 
         for(int i = 0; i < (int)as.size(); i++){
             auto var = get_var_from_array(as, i);
@@ -10279,8 +13378,8 @@ void Encoder::encode_array_set_element(const BasicVar& b, const ArrayLiteral& as
         if(i < 1 || i > (int)as.size())
             continue;
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
-        LiteralPtr yes_helper = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        LiteralPtr not_helper = encode_index_selector(b, i, cnf_clauses);
+        LiteralPtr yes_helper = negate_literal(not_helper);
         auto curr_var = *get_set_from_array(as, i-1);
 
         vector<int> elems;
@@ -10341,17 +13440,6 @@ void Encoder::encode_array_set_element(const BasicVar& b, const ArrayLiteral& as
                 sat_constraint_clauses.push_back(clause);
         }
 
-        cnf_clauses.push_back({make_literal(LiteralType::ORDER, b.id, true, i), not_helper});
-        cnf_clauses.push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1), not_helper});
-
-        if(export_proof){
-            helper_map[not_helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[not_helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1)});
-
-            sat_constraint_clauses.push_back({make_literal(LiteralType::ORDER, b.id, true, i), not_helper});
-            sat_constraint_clauses.push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1), not_helper});
-        }
-
         helpers.push_back(yes_helper);
     }
 
@@ -10394,8 +13482,8 @@ void Encoder::encode_array_var_set_element(const BasicVar& b, const ArrayLiteral
         if(i < 1 || i > (int)as.size())
             continue;
 
-        LiteralPtr not_helper = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
-        LiteralPtr yes_helper = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        LiteralPtr not_helper = encode_index_selector(b, i, cnf_clauses);
+        LiteralPtr yes_helper = negate_literal(not_helper);
         auto curr_var = *get_var_from_array(as, i-1);
 
         CNF temp_clauses;
@@ -10417,17 +13505,6 @@ void Encoder::encode_array_var_set_element(const BasicVar& b, const ArrayLiteral
                 sat_constraint_clauses.push_back(clause);
         }
 
-        cnf_clauses.push_back({make_literal(LiteralType::ORDER, b.id, true, i), not_helper});
-        cnf_clauses.push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1), not_helper});
-
-        if(export_proof){
-            helper_map[not_helper->id].push_back({make_literal(LiteralType::ORDER, b.id, true, i)});
-            helper_map[not_helper->id].push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1)});
-
-            sat_constraint_clauses.push_back({make_literal(LiteralType::ORDER, b.id, true, i), not_helper});
-            sat_constraint_clauses.push_back({make_literal(LiteralType::ORDER, b.id, false, i - 1), not_helper});            
-        }
-
         helpers.push_back(yes_helper);
     }
 
@@ -10493,22 +13570,18 @@ void Encoder::encode_set_substitution(const BasicVar &x, const BasicVar &x1, int
         x1_right = 1;
     }
 
-    encode_direct(x, cnf_clauses);
-    if(x1.id != x.id)
-        encode_direct(x1, cnf_clauses);
-
     //x = x1 + x2
     Clause helpers;
     for(int i = x_left; i <= x_right; i++){
         for(int j = x1_left; j <= x1_right; j++){
             for(int k = 0; k <= 1; k++){
                 if(j + k == i){
-                    LiteralPtr l_i = make_literal(LiteralType::DIRECT, x.id, true, i);
+                    LiteralPtr l_i = get_direct_literal(x, i, true, cnf_clauses);
                     LiteralPtr l_j;
                     if(x.id == x1.id)
                         l_j = make_literal(LiteralType::SET_ELEM, S.id, j == 0 ? false : true, val1);
                     else    
-                        l_j = make_literal(LiteralType::DIRECT, x1.id, true, j);
+                        l_j = get_direct_literal(x1, j, true, cnf_clauses);
                     LiteralPtr l_k = make_literal(LiteralType::SET_ELEM, S.id, k == 0 ? false : true, val2);
 
                     LiteralPtr not_helper = make_literal(LiteralType::HELPER, next_helper_id, false, 0);
@@ -10543,6 +13616,70 @@ void Encoder::encode_set_substitution(const BasicVar &x, const BasicVar &x1, int
 
 }
 
+// Encodes the unary count of the literals in [left, right) by a totalizer.
+// The returned literal out[k] is equivalent to at least k + 1 of them being set
+vector<LiteralPtr> Encoder::encode_unary_sum(const Clause& lits, int left, int right, CNF& cnf_clauses){
+
+    if(right - left == 1)
+        return {lits[left]};
+
+    int mid = (left + right) / 2;
+    vector<LiteralPtr> a = encode_unary_sum(lits, left, mid, cnf_clauses);
+    vector<LiteralPtr> b = encode_unary_sum(lits, mid, right, cnf_clauses);
+    int p = a.size();
+    int q = b.size();
+
+    vector<LiteralPtr> out(p + q);
+    for(auto& l : out)
+        l = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+
+    // a[i - 1] and b[j - 1] stand for at least i and j set literals, where
+    // the count of at least 0 is always true and the count above the size never is
+    for(int i = 0; i <= p; i++){
+        for(int j = 0; j <= q; j++){
+            if(i + j > 0){
+                Clause new_clause;
+                if(i > 0)
+                    new_clause.push_back(negate_literal(a[i - 1]));
+                if(j > 0)
+                    new_clause.push_back(negate_literal(b[j - 1]));
+                new_clause.push_back(out[i + j - 1]);
+                cnf_clauses.push_back(new_clause);
+            }
+
+            if(i + j < p + q){
+                Clause new_clause;
+                if(i < p)
+                    new_clause.push_back(a[i]);
+                if(j < q)
+                    new_clause.push_back(b[j]);
+                new_clause.push_back(negate_literal(out[i + j]));
+                cnf_clauses.push_back(new_clause);
+            }
+        }
+    }
+
+    return out;
+}
+
+// Returns the unary cardinality of the set S, encoded once per set variable
+vector<LiteralPtr> Encoder::encode_set_totalizer(const BasicVar& S, CNF& cnf_clauses){
+
+    if(auto cached = find_cached(&Encoder::set_card_map, S.id))
+        return *cached;
+
+    Clause lits;
+    for(auto elem : *get_set_elems(S))
+        lits.push_back(make_literal(LiteralType::SET_ELEM, S.id, true, elem));
+
+    vector<LiteralPtr> card;
+    if(!lits.empty())
+        card = encode_unary_sum(lits, 0, lits.size(), cnf_clauses);
+
+    set_card_map[S.id] = card;
+    return card;
+}
+
 // Encodes a constraint of type |S| = x
 void Encoder::encode_set_card(const BasicVar& S, const BasicVar& x, CNF& cnf_clauses){
 
@@ -10550,6 +13687,34 @@ void Encoder::encode_set_card(const BasicVar& S, const BasicVar& x, CNF& cnf_cla
     int left = get_left(&x);
     int right = get_right(&x);
 
+    // The totalizer's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        if(left > (int)elems.size() || right < 0){
+            declare_unsat(cnf_clauses);
+            return;
+        }
+
+        // card[j - 1] holds iff |S| >= j, which is x >= j inside the domain of x
+        vector<LiteralPtr> card = encode_set_totalizer(S, cnf_clauses);
+        for(int j = 1; j <= (int)card.size(); j++){
+            if(j <= left){
+                cnf_clauses.push_back({card[j - 1]});
+            } else if(j > right){
+                cnf_clauses.push_back({negate_literal(card[j - 1])});
+            } else {
+                cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, true, j - 1), card[j - 1]});
+                cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, false, j - 1), negate_literal(card[j - 1])});
+            }
+        }
+
+        if(left < 0)
+            cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, false, -1)});
+        if(right > (int)card.size())
+            cnf_clauses.push_back({make_literal(LiteralType::ORDER, x.id, true, card.size())});
+        return;
+    }
+
     if(export_proof){
         needOnes = true;
 
@@ -11737,9 +14902,129 @@ void Encoder::set_max(const BasicVar& x, const BasicVar& set, CNF &cnf_clauses){
     }
 }
 
+// Encodes, for every possible element e of the set s, a helper literal
+// equivalent to s containing an element greater or equal to e. The
+// helpers are shared between all constraints on s
+vector<LiteralPtr> Encoder::encode_set_suffix(const BasicVar& s, CNF& cnf_clauses){
+
+    if(auto cached = find_cached(&Encoder::set_suffix_map, s.id))
+        return *cached;
+
+    auto elems = *get_set_elems(s);
+    int n = elems.size();
+    vector<LiteralPtr> suffix(n);
+
+    for(int i = n - 1; i >= 0; i--){
+        suffix[i] = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+        LiteralPtr elem = make_literal(LiteralType::SET_ELEM, s.id, true, elems[i]);
+
+        cnf_clauses.push_back({negate_literal(elem), suffix[i]});
+        if(i < n - 1){
+            cnf_clauses.push_back({negate_literal(suffix[i + 1]), suffix[i]});
+            cnf_clauses.push_back({negate_literal(suffix[i]), elem, suffix[i + 1]});
+        } else {
+            cnf_clauses.push_back({negate_literal(suffix[i]), elem});
+        }
+    }
+
+    set_suffix_map[s.id] = suffix;
+    return suffix;
+}
+
+// Encodes the lexicographic comparison of x and y as sorted lists of
+// elements, which is decided at the smallest element d of their symmetric
+// difference: if d is in x, x < y iff y has an element greater than d, and
+// if d is in y, x < y iff x has none. Helper c[i] holds iff x <= y (x < y
+// if strict), given that x and y agree on the elements before position i.
+// Without r the comparison is asserted, otherwise r implies it and, if
+// reified, is implied by it
+void Encoder::encode_set_lex(const BasicVar& x, const BasicVar& y, bool strict, const BasicVar* r, bool reified, CNF& cnf_clauses){
+
+    auto x_elems = *get_set_elems(x);
+    auto y_elems = *get_set_elems(y);
+    vector<LiteralPtr> x_suffix = encode_set_suffix(x, cnf_clauses);
+    vector<LiteralPtr> y_suffix = encode_set_suffix(y, cnf_clauses);
+
+    vector<int> positions;
+    set_union(x_elems.begin(), x_elems.end(), y_elems.begin(), y_elems.end(), back_inserter(positions));
+
+    // A signal is a literal with a polarity, where the null literal stands
+    // for the constant false
+    using Signal = pair<LiteralPtr, bool>;
+    auto add_clause = [&](const vector<Signal>& signals){
+        Clause new_clause;
+        for(auto& [l, pol] : signals){
+            if(l == nullptr){
+                if(!pol)
+                    return;
+            } else {
+                new_clause.push_back(pol ? l : negate_literal(l));
+            }
+        }
+
+        if(new_clause.empty())
+            declare_unsat(cnf_clauses);
+        else
+            cnf_clauses.push_back(new_clause);
+    };
+
+    auto get_elem = [&](const BasicVar& s, const vector<int>& elems, int val) -> LiteralPtr {
+        if(binary_search(elems.begin(), elems.end(), val))
+            return make_literal(LiteralType::SET_ELEM, s.id, true, val);
+        return nullptr;
+    };
+
+    auto get_suffix_after = [&](const vector<int>& elems, const vector<LiteralPtr>& suffix, int val) -> LiteralPtr {
+        int ind = upper_bound(elems.begin(), elems.end(), val) - elems.begin();
+        return ind < (int)elems.size() ? suffix[ind] : nullptr;
+    };
+
+    // Equal sets are ordered by <= but not by <
+    Signal next = {nullptr, strict};
+    for(int i = (int)positions.size() - 1; i >= 0; i--){
+        int p = positions[i];
+        LiteralPtr x_p = get_elem(x, x_elems, p);
+        LiteralPtr y_p = get_elem(y, y_elems, p);
+        LiteralPtr c = make_literal(LiteralType::HELPER, next_helper_id++, true, 0);
+
+        Signal targets[2][2] = {{next, {get_suffix_after(x_elems, x_suffix, p), false}},
+                                {{get_suffix_after(y_elems, y_suffix, p), true}, next}};
+
+        for(int a = 0; a <= 1; a++){
+            for(int b = 0; b <= 1; b++){
+                Signal target = targets[a][b];
+                Signal x_cond = {x_p, a == 0};
+                Signal y_cond = {y_p, b == 0};
+
+                add_clause({x_cond, y_cond, {c, false}, target});
+                if(reified)
+                    add_clause({x_cond, y_cond, {c, true}, {target.first, !target.second}});
+            }
+        }
+
+        next = {c, true};
+    }
+
+    if(r == nullptr){
+        add_clause({next});
+    } else {
+        LiteralPtr yes_r = make_literal(LiteralType::BOOL_VARIABLE, r->id, true, 0);
+        add_clause({{yes_r, false}, next});
+        if(reified)
+            add_clause({{yes_r, true}, {next.first, !next.second}});
+    }
+}
+
 // Encodes a constraint of type x <= y
 void Encoder::encode_set_le(const BasicVar& x, const BasicVar& y, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, false, nullptr, false, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name});
 
@@ -12064,6 +15349,13 @@ void Encoder::encode_set_le(const BasicVar& x, const BasicVar& y, CNF &cnf_claus
 // Encodes a constraint of type (x <= y) <=> r
 void Encoder::encode_set_le_reif(const BasicVar& x, const BasicVar& y, const BasicVar& r, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, false, &r, true, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name, *r.name});
 
@@ -12396,6 +15688,13 @@ void Encoder::encode_set_le_reif(const BasicVar& x, const BasicVar& y, const Bas
 // Encodes a constraint of type (x <= y) => r
 void Encoder::encode_set_le_imp(const BasicVar& x, const BasicVar& y, const BasicVar& r, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, false, &r, false, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name, *r.name});
 
@@ -12727,6 +16026,13 @@ void Encoder::encode_set_le_imp(const BasicVar& x, const BasicVar& y, const Basi
 // Encodes a constraint of type x < y
 void Encoder::encode_set_lt(const BasicVar& x, const BasicVar& y, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, true, nullptr, false, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name});    
 
@@ -13054,6 +16360,13 @@ void Encoder::encode_set_lt(const BasicVar& x, const BasicVar& y, CNF &cnf_claus
 // Encodes a constraint of type (x < y) <=> r
 void Encoder::encode_set_lt_reif(const BasicVar& x, const BasicVar& y, const BasicVar& r, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, true, &r, true, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name, *r.name});
 
@@ -13389,6 +16702,13 @@ void Encoder::encode_set_lt_reif(const BasicVar& x, const BasicVar& y, const Bas
 // Encodes a constraint of type (x < y) => r
 void Encoder::encode_set_lt_imp(const BasicVar& x, const BasicVar& y, const BasicVar& r, CNF &cnf_clauses){
 
+    // The comparator's helpers have no definition in the proof, so the
+    // proof keeps the encoding below
+    if(!proof_requested){
+        encode_set_lex(x, y, true, &r, false, cnf_clauses);
+        return;
+    }
+
     if(export_proof)
         smt_constraints_vars.push_back({*x.name, *y.name, *r.name});
 
@@ -1,16 +1,19 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <csignal>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "../includes/parser.hpp"
 #include "../includes/encoder.hpp"
 
-extern int yyparse();
-extern FILE* yyin;
-
-extern YYSTYPE yyval;  
-
-vector<Item>* parsing_result = new vector<Item>;
-
 #include <fstream>
 #include <string>
 
@@ -29,6 +32,397 @@ bool has_optimization_goal(const char* filename) {
 }
 
 
+// Settings of the conversion, given on the command line
+struct Settings {
+    FileType file_type;
+    SolverType solver_type;
+    bool export_proof;
+    bool print_stats;
+    EncoderOptions options;
+    string forwarded_args;
+};
+
+// Creates a fresh directory under $TMPDIR, or /tmp. Returns an empty
+// string if it cannot be created
+string make_temporary_dir() {
+    const char* tmp = getenv("TMPDIR");
+    string dir = string(tmp && *tmp ? tmp : "/tmp") + "/flatzinc_to_sat.XXXXXX";
+    if (!mkdtemp(dir.data())) {
+        cerr << "Cannot create a working directory in " << (tmp && *tmp ? tmp : "/tmp") << endl;
+        return "";
+    }
+    return dir;
+}
+
+// Parses, encodes and solves one model, given by its file or read from
+// the standard input. The solution is printed to out, and the errors and
+// statistics to log
+int convert(const char* input_file, Settings settings, ostream& out = cout, ostream& log = cerr) {
+
+    const FileType file_type = settings.file_type;
+    const SolverType solver_type = settings.solver_type;
+    const bool export_proof = settings.export_proof;
+    EncoderOptions& options = settings.options;
+
+    if(input_file && !options.incremental && has_optimization_goal(input_file)){
+        string cmd;
+        if(export_proof)
+            cmd = "./optimizer -export-proof ";
+        else
+            cmd = "./optimizer ";
+        cmd += settings.forwarded_args;
+        if (!settings.options.work_dir.empty())
+            cmd += shell_quote("-workdir=" + settings.options.work_dir) + " ";
+        cmd += shell_quote(input_file);
+        FILE* optimizer = popen(cmd.c_str(), "r");
+        if (!optimizer) {
+            log << "Cannot run the optimizer" << endl;
+            return 1;
+        }
+        char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), optimizer)) > 0)
+            out.write(chunk, n);
+        out.flush();
+        return pclose(optimizer) == 0 ? 0 : 1;
+    }
+
+    FILE* input = stdin;
+    if (input_file) {
+        input = fopen(input_file, "r");
+        if (!input) {
+            log << "Could not open file " << input_file << endl;
+            return 1;
+        }
+    }
+
+    vector<Item> parsing_result;
+    int parse_status = parse_flatzinc(input, &parsing_result);
+    if (input != stdin)
+        fclose(input);
+    if(parse_status != 0){
+        log << "Parsing failed!" << endl;
+        return 1;
+    }
+
+    // Scratch files go to the given directory, or to a fresh one for
+    // -workdir=auto that is removed at the end unless it holds proofs
+    bool temporary_work_dir = options.work_dir == "auto";
+    if (temporary_work_dir) {
+        options.work_dir = make_temporary_dir();
+        if (options.work_dir.empty())
+            return 1;
+    } else if (!options.work_dir.empty()) {
+        error_code error;
+        filesystem::create_directories(options.work_dir, error);
+        if (error) {
+            log << "Cannot create the working directory " << options.work_dir << endl;
+            return 1;
+        }
+    }
+
+    Encoder encoder(parsing_result, file_type, solver_type, export_proof, options);
+
+    // A piped solver is started first and reads the clauses while they are encoded
+    if(options.pipe_solver)
+        encoder.run_solver("model.out");
+    auto clauses = encoder.encode_to_cnf();
+
+    encoder.write_to_file();
+    if(options.incremental){
+        encoder.optimize(out, log);
+    } else {
+        if(!options.pipe_solver)
+            encoder.run_solver("model.out");
+        encoder.read_solver_output("model.out", out);
+    }
+    if(settings.print_stats)
+        encoder.print_statistics(log);
+    if(export_proof)
+        encoder.generate_proof();
+
+    if(temporary_work_dir){
+        if(export_proof)
+            log << "The proofs are in " << options.work_dir << endl;
+        else
+            filesystem::remove_all(options.work_dir);
+    }
+
+    return 0;
+}
+
+volatile sig_atomic_t server_stopped = 0;
+
+void stop_server(int) {
+    server_stopped = 1;
+}
+
+void reap_children(int) {
+    int saved_errno = errno;
+    while (waitpid(-1, nullptr, WNOHANG) > 0)
+        ;
+    errno = saved_errno;
+}
+
+// Answers one request of the server. The request is the text of a model,
+// or a line "file PATH" naming a model file. Everything the conversion
+// prints, including the errors, is sent back to the client
+void serve_request(int client, const string& dir, const Settings& settings) {
+
+    string request;
+    char chunk[1 << 16];
+    ssize_t n;
+    while ((n = read(client, chunk, sizeof(chunk))) > 0 || (n < 0 && errno == EINTR))
+        if (n > 0)
+            request.append(chunk, n);
+
+    dup2(client, STDOUT_FILENO);
+    dup2(client, STDERR_FILENO);
+    close(client);
+
+    filesystem::create_directories(dir);
+    string input_file;
+    if (request.rfind("file ", 0) == 0) {
+        input_file = request.substr(5, request.find_first_of("\r\n") - 5);
+    } else {
+        input_file = dir + "/model.fzn";
+        ofstream(input_file) << request;
+    }
+
+    Settings request_settings = settings;
+    request_settings.options.work_dir = dir;
+    request_settings.options.start_time = chrono::steady_clock::now();
+    int status = convert(input_file.c_str(), request_settings);
+    cout.flush();
+
+    if (settings.export_proof)
+        cerr << "The proofs are in " << dir << endl;
+    else
+        filesystem::remove_all(dir);
+    exit(status);
+}
+
+// Accepts requests on a UNIX socket until the server is stopped. Each
+// request is served by a child forked from the already started server,
+// with its own working directory, so that requests are independent and
+// can be served at the same time
+int run_server(const string& socket_path, const Settings& settings) {
+
+    if (socket_path.size() >= sizeof(sockaddr_un::sun_path)) {
+        cerr << "The socket path is too long: " << socket_path << endl;
+        return 1;
+    }
+
+    // Without -workdir, the requests work in a temporary directory
+    string work_dir = settings.options.work_dir;
+    bool temporary_work_dir = work_dir.empty() || work_dir == "auto";
+    if (temporary_work_dir) {
+        work_dir = make_temporary_dir();
+        if (work_dir.empty())
+            return 1;
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socket_path.c_str());
+    if (server < 0 || bind(server, (sockaddr*)&address, sizeof(address)) < 0 || listen(server, 64) < 0) {
+        cerr << "Cannot listen on " << socket_path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    struct sigaction action{};
+    action.sa_handler = reap_children;
+    action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+    sigaction(SIGCHLD, &action, nullptr);
+    action.sa_handler = stop_server;
+    action.sa_flags = 0;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    cerr << "Listening on " << socket_path << endl;
+
+    long long requests = 0;
+    while (!server_stopped) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        string dir = work_dir + "/request" + to_string(++requests);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(server);
+            signal(SIGCHLD, SIG_DFL);
+            signal(SIGINT, SIG_DFL);
+            signal(SIGTERM, SIG_DFL);
+            signal(SIGPIPE, SIG_DFL);
+            serve_request(client, dir, settings);
+        }
+        if (pid < 0)
+            cerr << "Cannot serve a request: " << strerror(errno) << endl;
+        close(client);
+    }
+
+    close(server);
+    unlink(socket_path.c_str());
+    if (temporary_work_dir && !settings.export_proof)
+        filesystem::remove_all(work_dir);
+    return 0;
+}
+
+// Sends a model, given by its file or read from the standard input, to
+// a server and prints its answer
+int run_client(const string& socket_path, const char* input_file) {
+
+    stringstream model;
+    if (input_file) {
+        ifstream in(input_file);
+        if (!in) {
+            cerr << "Could not open file " << input_file << endl;
+            return 1;
+        }
+        model << in.rdbuf();
+    } else {
+        model << cin.rdbuf();
+    }
+
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    if (client < 0 || connect(client, (sockaddr*)&address, sizeof(address)) < 0) {
+        cerr << "Cannot connect to " << socket_path << ": " << strerror(errno) << endl;
+        return 1;
+    }
+
+    string request = model.str();
+    for (size_t sent = 0; sent < request.size(); ) {
+        ssize_t n = write(client, request.data() + sent, request.size() - sent);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            cerr << "Cannot send the model: " << strerror(errno) << endl;
+            return 1;
+        }
+        sent += n;
+    }
+    shutdown(client, SHUT_WR);
+
+    char chunk[1 << 16];
+    ssize_t n;
+    while ((n = read(client, chunk, sizeof(chunk))) > 0 || (n < 0 && errno == EINTR))
+        if (n > 0)
+            cout.write(chunk, n);
+    close(client);
+    return 0;
+}
+
+// Returns the status of an answer written by the converter or by the
+// optimizer: sat, unsat or unknown. Both the converter's format and the
+// MiniZinc format of the anytime option are understood
+string answer_status(const string& answer) {
+
+    istringstream lines(answer);
+    string line;
+    while (getline(lines, line)) {
+        if (line == "UNSAT" || line == "=====UNSATISFIABLE=====")
+            return "unsat";
+        if (line == "UNKNOWN" || line == "=====UNKNOWN=====")
+            return "unknown";
+        if (line == "SAT" || line == "----------")
+            return "sat";
+    }
+    return "unknown";
+}
+
+// Converts many models, given by their files or by directories of .fzn
+// files, with a pool of worker threads. Each worker converts one model at
+// a time with its own encoder, working directory and solver. The result
+// of each model is printed once it is done, followed by a summary
+int run_batch(const vector<string>& inputs, int jobs, const Settings& settings) {
+
+    vector<string> models;
+    for (auto& input : inputs) {
+        if (!filesystem::is_directory(input)) {
+            models.push_back(input);
+            continue;
+        }
+        vector<string> dir_models;
+        for (auto& entry : filesystem::directory_iterator(input))
+            if (entry.path().extension() == ".fzn")
+                dir_models.push_back(entry.path().string());
+        sort(dir_models.begin(), dir_models.end());
+        models.insert(models.end(), dir_models.begin(), dir_models.end());
+    }
+
+    string work_dir = settings.options.work_dir;
+    bool temporary_work_dir = work_dir.empty() || work_dir == "auto";
+    if (temporary_work_dir) {
+        work_dir = make_temporary_dir();
+        if (work_dir.empty())
+            return 1;
+    }
+
+    atomic<size_t> next_model{0};
+    mutex print_mutex;
+    int sat_num = 0, unsat_num = 0, unknown_num = 0, failed_num = 0;
+    auto batch_start = chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next_model++) < models.size()) {
+            Settings model_settings = settings;
+            model_settings.options.work_dir = work_dir + "/model" + to_string(i + 1);
+
+            auto start = chrono::steady_clock::now();
+            model_settings.options.start_time = start;
+            ostringstream result;
+            int status = convert(models[i].c_str(), model_settings, result, result);
+            chrono::duration<double> time = chrono::steady_clock::now() - start;
+            if (!settings.export_proof)
+                filesystem::remove_all(model_settings.options.work_dir);
+
+            string answer = result.str();
+            lock_guard<mutex> lock(print_mutex);
+            string answer_type = answer_status(answer);
+            if (status != 0 || answer.empty())
+                failed_num++;
+            else if (answer_type == "sat")
+                sat_num++;
+            else if (answer_type == "unsat")
+                unsat_num++;
+            else
+                unknown_num++;
+            cout << "% " << models[i] << " (" << time.count() << " s)\n" << answer;
+            if (status != 0)
+                cout << "% failed\n";
+            cout << flush;
+        }
+    };
+
+    vector<thread> workers;
+    for (int i = 0; i < jobs && i < (int)models.size(); i++)
+        workers.emplace_back(worker);
+    for (auto& t : workers)
+        t.join();
+
+    chrono::duration<double> time = chrono::steady_clock::now() - batch_start;
+    cout << "% " << models.size() << " models in " << time.count() << " s with " << jobs << " workers, "
+         << (time.count() > 0 ? models.size() / time.count() : 0) << " models/s: "
+         << sat_num << " SAT, " << unsat_num << " UNSAT, " << unknown_num << " unknown, "
+         << failed_num << " failed" << endl;
+
+    if (temporary_work_dir) {
+        if (settings.export_proof)
+            cerr << "The proofs are in " << work_dir << endl;
+        else
+            filesystem::remove_all(work_dir);
+    }
+    return failed_num == 0 ? 0 : 1;
+}
+
 int main(int argc, char** argv) {
 
     ios::sync_with_stdio(false);
@@ -38,11 +432,22 @@ int main(int argc, char** argv) {
     FileType file_type = DIMACS;
     SolverType solver_type = MINISAT;
     const char* input_file = nullptr;
-    bool export_proof;
+    bool export_proof = false;
+    EncoderOptions options;
+    options.start_time = chrono::steady_clock::now();
+    bool print_stats = false;
+    string forwarded_args;
+    string server_socket, client_socket;
+    int batch_jobs = 0;
+    vector<string> inputs;
 
     for (int i = 1; i < argc; ++i) {
         string arg(argv[i]);
 
+        if (arg[0] == '-' && arg.rfind("-export-proof", 0) != 0 && arg.rfind("-workdir=", 0) != 0 &&
+            arg.rfind("-server=", 0) != 0 && arg.rfind("-client=", 0) != 0 && arg.rfind("-batch", 0) != 0)
+            forwarded_args += arg + " ";
+
         if (arg.rfind("-solver=", 0) == 0) {
             string solver = arg.substr(8);
             if (solver == "minisat") solver_type = MINISAT;
@@ -50,6 +455,7 @@ int main(int argc, char** argv) {
             else if (solver == "glucose") solver_type = GLUCOSE;
             else if (solver == "z3") solver_type = Z3;
             else if (solver == "cvc5") solver_type = CVC5;
+            else if (solver == "cryptominisat") solver_type = CRYPTOMINISAT;
             else {
                 cerr << "Unknown solver: " << solver << endl;
                 return 1;
@@ -62,52 +468,162 @@ int main(int argc, char** argv) {
                 cerr << "Unknown file type: " << file << endl;
                 return 1;
             }
+        } else if (arg.rfind("-times=", 0) == 0) {
+            string encoding = arg.substr(7);
+            if (encoding == "auto") options.times_encoding = TIMES_AUTO;
+            else if (encoding == "order") options.times_encoding = TIMES_ORDER;
+            else if (encoding == "table") options.times_encoding = TIMES_TABLE;
+            else if (encoding == "binary") options.times_encoding = TIMES_BINARY;
+            else {
+                cerr << "Unknown int_times encoding: " << encoding << endl;
+                return 1;
+            }
+        } else if (arg.rfind("-pb=", 0) == 0) {
+            string encoding = arg.substr(4);
+            if (encoding == "auto") options.pb_encoding = PB_AUTO;
+            else if (encoding == "sequential") options.pb_encoding = PB_SEQUENTIAL;
+            else if (encoding == "totalizer") options.pb_encoding = PB_TOTALIZER;
+            else if (encoding == "sorter") options.pb_encoding = PB_SORTER;
+            else if (encoding == "bdd") options.pb_encoding = PB_BDD;
+            else {
+                cerr << "Unknown pseudo-Boolean encoding: " << encoding << endl;
+                return 1;
+            }
+        } else if (arg.rfind("-xor-chunk=", 0) == 0) {
+            options.xor_chunk = atoi(arg.substr(11).c_str());
+            if (options.xor_chunk < 3) {
+                cerr << "The XOR chunk size must be at least 3" << endl;
+                return 1;
+            }
+        } else if (arg == "-xor-clauses") {
+            options.xor_clauses = true;
+        } else if (arg == "-no-dedup") {
+            options.dedup = false;
+        } else if (arg.rfind("-subsume=", 0) == 0) {
+            options.subsume_window = atoi(arg.substr(9).c_str());
+        } else if (arg.rfind("-portfolio=", 0) == 0) {
+            stringstream configs(arg.substr(11));
+            string config;
+            while (getline(configs, config, ',')) {
+                string solver = config.substr(0, config.find(':'));
+                int seed = config.find(':') == string::npos ? -1 : atoi(config.substr(config.find(':') + 1).c_str());
+                if (solver == "minisat") options.portfolio.push_back({MINISAT, seed});
+                else if (solver == "cadical") options.portfolio.push_back({CADICAL, seed});
+                else if (solver == "glucose") options.portfolio.push_back({GLUCOSE, seed});
+                else if (solver == "cryptominisat") options.portfolio.push_back({CRYPTOMINISAT, seed});
+                else {
+                    cerr << "Unknown portfolio solver: " << solver << endl;
+                    return 1;
+                }
+            }
+        } else if (arg.rfind("-workdir=", 0) == 0) {
+            options.work_dir = arg.substr(9);
+            if (options.work_dir.empty()) {
+                cerr << "The working directory cannot be empty" << endl;
+                return 1;
+            }
+        } else if (arg.rfind("-server=", 0) == 0) {
+            server_socket = arg.substr(8);
+        } else if (arg.rfind("-client=", 0) == 0) {
+            client_socket = arg.substr(8);
+        } else if (arg == "-batch") {
+            batch_jobs = max(1u, thread::hardware_concurrency());
+        } else if (arg.rfind("-batch=", 0) == 0) {
+            batch_jobs = atoi(arg.substr(7).c_str());
+            if (batch_jobs < 1) {
+                cerr << "The number of batch workers must be at least 1" << endl;
+                return 1;
+            }
+        } else if (arg.rfind("-encode-threads=", 0) == 0) {
+            options.encode_threads = atoi(arg.substr(16).c_str());
+            if (options.encode_threads < 1) {
+                cerr << "The number of encoding threads must be at least 1" << endl;
+                return 1;
+            }
+        } else if (arg == "-incremental") {
+            options.incremental = true;
+        } else if (arg == "-core-guided") {
+            options.incremental = true;
+            options.core_guided = true;
+        } else if (arg == "-lns") {
+            options.incremental = true;
+            options.lns = true;
+        } else if (arg.rfind("-lns=", 0) == 0) {
+            options.incremental = true;
+            options.lns = true;
+            options.lns_threads = atoi(arg.substr(5).c_str());
+            if (options.lns_threads < 1) {
+                cerr << "The number of LNS threads must be at least 1" << endl;
+                return 1;
+            }
+        } else if (arg == "-anytime") {
+            options.anytime = true;
+        } else if (arg.rfind("-time-limit=", 0) == 0) {
+            options.time_limit = atoll(arg.substr(12).c_str());
+            if (options.time_limit < 1) {
+                cerr << "The time limit must be at least 1 ms" << endl;
+                return 1;
+            }
+        } else if (arg.rfind("-conflict-limit=", 0) == 0) {
+            options.conflict_limit = atoll(arg.substr(16).c_str());
+            if (options.conflict_limit < 1) {
+                cerr << "The conflict limit must be at least 1" << endl;
+                return 1;
+            }
+        } else if (arg == "-pipe") {
+            options.pipe_solver = true;
+        } else if (arg == "-stats") {
+            print_stats = true;
+        } else if (arg == "-split-proof") {
+            options.split_proof = true;
         } else if (arg.rfind("-export-proof", 0) == 0) {
             export_proof = true;
         } else if (arg[0] != '-') {
-            input_file = argv[i]; 
+            input_file = argv[i];
+            inputs.push_back(arg);
         } else {
             cerr << "Unknown option: " << arg << endl;
             return 1;
         }
     }
 
-    if(input_file && has_optimization_goal(input_file)){
-        string cmd;
-        if(export_proof)
-            cmd = "./optimizer -export-proof ";
-        else
-            cmd = "./optimizer ";
-        cmd += input_file;
-        system(cmd.c_str());
-        return 0;
+    if (!options.portfolio.empty() && (options.pipe_solver || file_type != DIMACS)) {
+        cerr << "The option -portfolio needs a DIMACS formula and cannot be used with -pipe" << endl;
+        return 1;
     }
 
-    if (input_file) {
-        yyin = fopen(input_file, "r");
-        if (!yyin) {
-            cerr << "Could not open file " << input_file << endl;
-            return 1;
-        }
-    } else {
-        yyin = stdin;
+    if (options.pipe_solver && (export_proof || file_type != DIMACS ||
+        (solver_type != MINISAT && solver_type != CADICAL && solver_type != CRYPTOMINISAT))) {
+        cerr << "The option -pipe needs a DIMACS formula, minisat, cadical or cryptominisat and no proof export" << endl;
+        return 1;
     }
 
-    if(yyparse() != 0){
-        cerr << "Parsing failed!" << endl;
+    bool xor_solvers = options.portfolio.empty() ? solver_type == CRYPTOMINISAT :
+        all_of(options.portfolio.begin(), options.portfolio.end(),
+               [](const pair<SolverType, int>& config) { return config.first == CRYPTOMINISAT; });
+    if (options.xor_clauses && (file_type != DIMACS || !xor_solvers)) {
+        cerr << "The option -xor-clauses needs a DIMACS formula and cryptominisat as the only solver" << endl;
         return 1;
     }
 
-    Encoder encoder(*parsing_result, file_type, solver_type, export_proof);
-    auto clauses = encoder.encode_to_cnf();
+    if (options.incremental && (export_proof || file_type != SMTLIB || (solver_type != Z3 && solver_type != CVC5))) {
+        cerr << "The options -incremental, -core-guided and -lns need an SMT-LIB formula, z3 or cvc5 and no proof export" << endl;
+        return 1;
+    }
 
-    encoder.write_to_file();
-    encoder.run_solver("model.out");
-    encoder.read_solver_output("model.out");
-    if(export_proof)
-        encoder.generate_proof();
+    if (options.split_proof && !export_proof) {
+        cerr << "The option -split-proof needs -export-proof" << endl;
+        return 1;
+    }
 
+    Settings settings{file_type, solver_type, export_proof, print_stats, options, forwarded_args};
 
+    if (!server_socket.empty())
+        return run_server(server_socket, settings);
+    if (!client_socket.empty())
+        return run_client(client_socket, input_file);
+    if (batch_jobs > 0)
+        return run_batch(inputs, batch_jobs, settings);
 
-    return 0;
+    return convert(input_file, settings);
 }
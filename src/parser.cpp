@@ -46,7 +46,7 @@
 #define YYSKELETON_NAME "glr.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 1
 
 
 
@@ -57,14 +57,10 @@
 #line 1 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
 
 
-int yylex();
-
-#define yyerror printf
-
 #include <iostream>
 
 
-#line 68 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 64 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -487,14 +483,14 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   281,   281,   302,   306,   314,   321,   326,   333,   342,
-     350,   363,   370,   378,   379,   383,   387,   394,   401,   405,
-     409,   414,   422,   425,   428,   432,   440,   446,   447,   448,
-     452,   456,   463,   464,   468,   472,   479,   482,   488,   492,
-     496,   501,   509,   515,   521,   526,   535,   539,   547,   553,
-     558,   566,   581,   596,   613,   619,   628,   641,   646,   654,
-     655,   656,   660,   664,   672,   675,   681,   686,   694,   697,
-     700,   706,   709,   712
+       0,   291,   291,   313,   317,   325,   332,   337,   344,   353,
+     361,   374,   381,   389,   390,   394,   398,   405,   412,   416,
+     420,   425,   433,   436,   439,   443,   451,   457,   458,   459,
+     463,   467,   474,   475,   479,   483,   490,   493,   499,   503,
+     507,   512,   520,   526,   532,   537,   546,   550,   558,   564,
+     569,   577,   592,   607,   624,   630,   639,   652,   657,   665,
+     666,   667,   671,   675,   683,   686,   692,   697,   705,   708,
+     711,   717,   720,   723
 };
 #endif
 
@@ -733,10 +729,16 @@ static const short yyconfl[] =
 
 
 
-YYSTYPE yylval;
 
-int yynerrs;
-int yychar;
+#undef yynerrs
+#define yynerrs (yystackp->yyerrcnt)
+#undef yychar
+#define yychar (yystackp->yyrawchar)
+#undef yylval
+#define yylval (yystackp->yyval)
+#undef yylloc
+#define yylloc (yystackp->yyloc)
+
 
 enum { YYENOMEM = -2 };
 
@@ -867,6 +869,10 @@ struct yyGLRStack {
   int yyerrState;
 
 
+  int yyerrcnt;
+  int yyrawchar;
+  YYSTYPE yyval;
+
   YYJMP_BUF yyexception_buffer;
   yyGLRStackItem* yyitems;
   yyGLRStackItem* yynextFree;
@@ -881,10 +887,10 @@ static void yyexpandGLRStack (yyGLRStack* yystackp);
 #endif
 
 _Noreturn static void
-yyFail (yyGLRStack* yystackp, const char* yymsg)
+yyFail (yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner, const char* yymsg)
 {
   if (yymsg != YY_NULLPTR)
-    yyerror (yymsg);
+    yyerror (parsing_result, scanner, yymsg);
   YYLONGJMP (yystackp->yyexception_buffer, 1);
 }
 
@@ -978,10 +984,12 @@ yylhsNonterm (yyRuleNum yyrule)
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, vector<Item>* parsing_result, yyscan_t scanner)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (parsing_result);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
@@ -996,12 +1004,12 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, vector<Item>* parsing_result, yyscan_t scanner)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, parsing_result, scanner);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1010,14 +1018,14 @@ yy_symbol_print (FILE *yyo,
     if (yydebug)                                                        \
       {                                                                 \
         YY_FPRINTF ((stderr, "%s ", Title));                            \
-        yy_symbol_print (stderr, Kind, Value);        \
+        yy_symbol_print (stderr, Kind, Value, parsing_result, scanner);        \
         YY_FPRINTF ((stderr, "\n"));                                    \
       }                                                                 \
   } while (0)
 
 static inline void
 yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
-                 yyRuleNum yyrule);
+                 yyRuleNum yyrule, vector<Item>* parsing_result, yyscan_t scanner);
 
 # define YY_REDUCE_PRINT(Args)          \
   do {                                  \
@@ -1072,13 +1080,15 @@ yyfillin (yyGLRStackItem *yyvsp, int yylow0, int yylow1)
 
 /** If yychar is empty, fetch the next token.  */
 static inline yysymbol_kind_t
-yygetToken (int *yycharp)
+yygetToken (int *yycharp, yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   yysymbol_kind_t yytoken;
+  YY_USE (parsing_result);
+  YY_USE (scanner);
   if (*yycharp == YYEMPTY)
     {
       YY_DPRINTF ((stderr, "Reading a token\n"));
-      *yycharp = yylex ();
+      *yycharp = yylex (&yylval, scanner);
     }
   if (*yycharp <= YYEOF)
     {
@@ -1118,11 +1128,13 @@ yyfill (yyGLRStackItem *yyvsp, int *yylow, int yylow1, yybool yynormal)
 static YYRESULTTAG
 yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
               yyGLRStack* yystackp, YYPTRDIFF_T yyk,
-              YYSTYPE* yyvalp)
+              YYSTYPE* yyvalp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   const yybool yynormal YY_ATTRIBUTE_UNUSED = yystackp->yysplitPoint == YY_NULLPTR;
   int yylow = 1;
   YY_USE (yyvalp);
+  YY_USE (parsing_result);
+  YY_USE (scanner);
   YY_USE (yyk);
   YY_USE (yyrhslen);
 # undef yyerrok
@@ -1143,7 +1155,7 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
 # define YYFILL(N) yyfill (yyvsp, &yylow, (N), yynormal)
 # undef YYBACKUP
 # define YYBACKUP(Token, Value)                                              \
-  return yyerror (YY_("syntax error: cannot back up")),     \
+  return yyerror (parsing_result, scanner, YY_("syntax error: cannot back up")),     \
          yyerrok, yyerr
 
   if (yyrhslen == 0)
@@ -1153,11 +1165,11 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
   /* If yyk == -1, we are running a deferred action on a temporary
      stack.  In that case, YY_REDUCE_PRINT must not play with YYFILL,
      so pretend the stack is "normal". */
-  YY_REDUCE_PRINT ((yynormal || yyk == -1, yyvsp, yyk, yyrule));
+  YY_REDUCE_PRINT ((yynormal || yyk == -1, yyvsp, yyk, yyrule, parsing_result, scanner));
   switch (yyrule)
     {
   case 2: /* model: predicate_item_list par_decl_item_list var_decl_item_list constraint_item_list solve_item  */
-#line 285 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 295 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                {
         if(!(((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.predicate_vector_attr))->empty()))
             for(auto elem : *((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.predicate_vector_attr)))
@@ -1171,69 +1183,70 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
         if(!(((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.constraint_vector_attr))->empty()))    
             for(auto elem : *((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.constraint_vector_attr)))
                 parsing_result->emplace_back(elem);
+        parsing_result->emplace_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.solve_attr));
     }
-#line 1176 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1189 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 3: /* predicate_item_list: %empty  */
-#line 302 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 313 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<Predicate*>* v = new vector<Predicate*>;
         ((*yyvalp).predicate_vector_attr) = v;
     }
-#line 1185 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1198 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 4: /* predicate_item_list: predicate_item predicate_item_list  */
-#line 306 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 317 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                         {       
         vector<Predicate*>* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.predicate_vector_attr);
         v->emplace(v->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.pred_attr));
         ((*yyvalp).predicate_vector_attr) = v;
     }
-#line 1195 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1208 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 5: /* predicate_item: PREDICATE VAR_PAR_IDENTIFIER OPEN_PARENT_SMALL predicate_params CLOSED_PARENT_SMALL  */
-#line 314 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 325 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                                         {
         Predicate* pred = new Predicate((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.pred_params_attr));
         ((*yyvalp).pred_attr) = pred;
     }
-#line 1204 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1217 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 6: /* predicate_params: predicate_param COMMA predicate_params  */
-#line 321 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 332 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                              { 
         vector<PredicateParam*>* p = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.pred_params_attr);
         p->emplace(p->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.pred_param_attr));
         ((*yyvalp).pred_params_attr) = p; 
      }
-#line 1214 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1227 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 7: /* predicate_params: predicate_param  */
-#line 326 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 337 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                       { 
         vector<PredicateParam*>* p = new vector<PredicateParam*>{(YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.pred_param_attr)};
         ((*yyvalp).pred_params_attr) = p; 
     }
-#line 1223 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1236 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 8: /* predicate_param: pred_param_type COLON VAR_PAR_IDENTIFIER  */
-#line 333 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 344 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                              {
         
         PredicateParam* p = new PredicateParam((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.basic_pred_param_type_attr));
         ((*yyvalp).pred_param_attr) = p;
     }
-#line 1233 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1246 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 9: /* par_type: BASIC_PAR_TYPE  */
-#line 342 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 353 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                   {
         if((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_par_type_attr) == BasicParType::INT)
             ((*yyvalp).par_type_attr) = new ParType(BasicParType::INT);
@@ -1242,11 +1255,11 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
         else if((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_par_type_attr) == BasicParType::SETOFINT)
             ((*yyvalp).par_type_attr) = new ParType(BasicParType::SETOFINT);
     }
-#line 1246 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1259 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 10: /* par_type: ARRAY OPEN_PARENT_MED index_set CLOSED_PARENT_MED OF BASIC_PAR_TYPE  */
-#line 350 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 361 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                          {
         if((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_par_type_attr) == BasicParType::INT){
             ParArrayType* p = new ParArrayType(BasicParType::INT, (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.int_attr));
@@ -1256,53 +1269,53 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
             ((*yyvalp).par_type_attr) = new ParType(p);
         }
     }
-#line 1260 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1273 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 11: /* array_var_type: ARRAY OPEN_PARENT_MED index_set CLOSED_PARENT_MED OF basic_var_type  */
-#line 363 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 374 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                         {
         ((*yyvalp).array_var_type_attr) = new ArrayVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.int_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_var_type_attr));
     }
-#line 1268 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1281 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 12: /* index_set: INT_LITERAL TWO_DOTS INT_LITERAL  */
-#line 370 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 381 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                      { 
         if ((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr) != 1){
-            yyerror("Error: first term in index set must be 1\n");
+            yyerror(parsing_result, scanner, "Error: first term in index set must be 1\n");
         }
         ((*yyvalp).int_attr) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr); }
-#line 1278 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1291 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 13: /* basic_var_type: VAR BASIC_PAR_TYPE  */
-#line 378 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 389 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        { ((*yyvalp).basic_var_type_attr) = new BasicVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_par_type_attr)); }
-#line 1284 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1297 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 14: /* basic_var_type: VAR INT_LITERAL TWO_DOTS INT_LITERAL  */
-#line 379 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 390 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                            { 
         IntRangeVarType* v = new IntRangeVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr));
         ((*yyvalp).basic_var_type_attr) = new BasicVarType(v); 
     }
-#line 1293 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1306 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 15: /* basic_var_type: VAR OPEN_PARENT_BIG int_literal_list  */
-#line 383 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 394 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                            {
         IntSetVarType* v = new IntSetVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.vector_of_int_attr));
         ((*yyvalp).basic_var_type_attr) = new BasicVarType(v);
     }
-#line 1302 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1315 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 16: /* basic_var_type: VAR SET OF INT_LITERAL TWO_DOTS INT_LITERAL  */
-#line 387 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 398 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                   {
         vector<int>* elems = new vector<int>;
         for(int i = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr); i <= (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr); i++)
@@ -1310,300 +1323,300 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
         SetVarType* v = new SetVarType(elems);
         ((*yyvalp).basic_var_type_attr) = new BasicVarType(v); 
     }
-#line 1314 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1327 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 17: /* basic_var_type: VAR SET OF OPEN_PARENT_BIG int_literal_list  */
-#line 394 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 405 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                   {
         SetVarType* v = new SetVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.vector_of_int_attr));
         ((*yyvalp).basic_var_type_attr) = new BasicVarType(v);
     }
-#line 1323 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1336 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 18: /* int_literal_list: %empty  */
-#line 401 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 412 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<int>* v = new vector<int>;
         ((*yyvalp).vector_of_int_attr) = v;
     }
-#line 1332 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1345 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 19: /* int_literal_list: CLOSED_PARENT_BIG  */
-#line 405 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 416 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                         {
         vector<int>* v = new vector<int>;
         ((*yyvalp).vector_of_int_attr) = v;
     }
-#line 1341 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1354 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 20: /* int_literal_list: INT_LITERAL CLOSED_PARENT_BIG  */
-#line 409 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 420 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                    {
         vector<int>* v = new vector<int>;
         v->emplace(v->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.int_attr));
         ((*yyvalp).vector_of_int_attr) = v;
     }
-#line 1351 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1364 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 21: /* int_literal_list: INT_LITERAL COMMA int_literal_list  */
-#line 414 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 425 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                         {
         vector<int>* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.vector_of_int_attr);
         v->emplace(((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.vector_of_int_attr))->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr));
         ((*yyvalp).vector_of_int_attr) = v;
     }
-#line 1361 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1374 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 22: /* basic_pred_param_type: BASIC_PAR_TYPE  */
-#line 422 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 433 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                    {
         ((*yyvalp).basic_pred_param_type_attr) = new BasicPredParamType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_par_type_attr));
     }
-#line 1369 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1382 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 23: /* basic_pred_param_type: basic_var_type  */
-#line 425 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 436 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                      {
         ((*yyvalp).basic_pred_param_type_attr) = new BasicPredParamType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_var_type_attr));
     }
-#line 1377 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1390 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 24: /* basic_pred_param_type: INT_LITERAL TWO_DOTS INT_LITERAL  */
-#line 428 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 439 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                        {
         IntRangeVarType* t = new IntRangeVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr));
         ((*yyvalp).basic_pred_param_type_attr) = new BasicPredParamType(t);
     }
-#line 1386 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1399 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 25: /* basic_pred_param_type: OPEN_PARENT_BIG int_literal_list CLOSED_PARENT_BIG  */
-#line 432 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 443 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                         {
         IntSetVarType* t = new IntSetVarType((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.vector_of_int_attr));
         ((*yyvalp).basic_pred_param_type_attr) = new BasicPredParamType(t);
     }
-#line 1395 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1408 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 26: /* pred_param_type: basic_pred_param_type  */
-#line 440 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 451 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                           { ((*yyvalp).basic_pred_param_type_attr) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_pred_param_type_attr);}
-#line 1401 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1414 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 27: /* basic_literal_expr: BOOL_LITERAL  */
-#line 446 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 457 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                  { ((*yyvalp).basic_literal_expr_attr) = new BasicLiteralExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.bool_attr)); }
-#line 1407 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1420 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 28: /* basic_literal_expr: INT_LITERAL  */
-#line 447 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 458 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                   { ((*yyvalp).basic_literal_expr_attr) = new BasicLiteralExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr)); }
-#line 1413 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1426 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 29: /* basic_literal_expr: set_literal  */
-#line 448 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 459 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                   { ((*yyvalp).basic_literal_expr_attr) = new BasicLiteralExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.set_literal_attr)); }
-#line 1419 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1432 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 30: /* set_literal: INT_LITERAL TWO_DOTS INT_LITERAL  */
-#line 452 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 463 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                      {
         SetRangeLiteral* v = new SetRangeLiteral((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.int_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.int_attr));
         ((*yyvalp).set_literal_attr) = new SetLiteral(v); 
     }
-#line 1428 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1441 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 31: /* set_literal: OPEN_PARENT_BIG int_literal_list  */
-#line 456 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 467 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                        {
         SetSetLiteral* v = new SetSetLiteral((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.vector_of_int_attr));
         ((*yyvalp).set_literal_attr) = new SetLiteral(v);
     }
-#line 1437 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1450 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 32: /* basic_expr: basic_literal_expr  */
-#line 463 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 474 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        { ((*yyvalp).basic_expr_attr) = new BasicExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_literal_expr_attr)); }
-#line 1443 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1456 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 33: /* basic_expr: VAR_PAR_IDENTIFIER  */
-#line 464 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 475 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                          { ((*yyvalp).basic_expr_attr) = new BasicExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.str_attr)); }
-#line 1449 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1462 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 34: /* expr: basic_expr  */
-#line 468 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 479 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                {
         BasicExpr* b = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_expr_attr);
         ((*yyvalp).expr_attr) = new Expr(b);
     }
-#line 1458 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1471 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 35: /* expr: array_literal  */
-#line 472 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 483 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                     {
         ArrayLiteral* a = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.array_literal_attr);
         ((*yyvalp).expr_attr) = new Expr(a);
     }
-#line 1467 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1480 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 36: /* par_expr: basic_literal_expr  */
-#line 479 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 490 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        {
         ((*yyvalp).par_expr_attr) = new ParExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_literal_expr_attr));
     }
-#line 1475 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1488 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 37: /* par_expr: par_array_literal  */
-#line 482 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 493 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        {
         ((*yyvalp).par_expr_attr) = new ParExpr((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.par_array_literal_attr));
     }
-#line 1483 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1496 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 38: /* array_literal: OPEN_PARENT_MED array_item_list CLOSED_PARENT_MED  */
-#line 488 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 499 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                      { ((*yyvalp).array_literal_attr) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.array_literal_attr); }
-#line 1489 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1502 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 39: /* array_item_list: %empty  */
-#line 492 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 503 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
           ((*yyvalp).array_literal_attr) = new ArrayLiteral();   
     }
-#line 1497 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1510 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 40: /* array_item_list: basic_expr  */
-#line 496 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 507 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                {
         ArrayLiteral* v = new ArrayLiteral();
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_expr_attr));
         ((*yyvalp).array_literal_attr) = v;
     }
-#line 1507 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1520 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 41: /* array_item_list: array_item_list COMMA basic_expr  */
-#line 501 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 512 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                        {
         ArrayLiteral* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.array_literal_attr);
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_expr_attr));
         ((*yyvalp).array_literal_attr) = v;
     }
-#line 1517 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1530 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 42: /* par_array_literal: OPEN_PARENT_MED par_array_item_list CLOSED_PARENT_MED  */
-#line 509 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 520 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                          {
         ((*yyvalp).par_array_literal_attr) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.par_array_literal_attr);
     }
-#line 1525 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1538 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 43: /* par_array_item_list: %empty  */
-#line 515 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 526 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<BasicLiteralExpr*>* v = new vector<BasicLiteralExpr*>;
         ParArrayLiteral* p = new ParArrayLiteral(v); 
         ((*yyvalp).par_array_literal_attr) = p;
 
     }
-#line 1536 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1549 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 44: /* par_array_item_list: basic_literal_expr COMMA par_array_item_list  */
-#line 521 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 532 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                    {
         ParArrayLiteral* p = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.par_array_literal_attr);
         p->elems->emplace(p->elems->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.basic_literal_expr_attr));
         ((*yyvalp).par_array_literal_attr) = p;
     }
-#line 1546 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1559 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 45: /* par_array_item_list: basic_literal_expr par_array_item_list  */
-#line 526 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 537 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                              {
         ParArrayLiteral* p = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.par_array_literal_attr);
         p->elems->emplace(p->elems->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.basic_literal_expr_attr));
         ((*yyvalp).par_array_literal_attr) = p;
     }
-#line 1556 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1569 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 46: /* par_decl_item_list: %empty  */
-#line 535 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 546 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<Parameter*>* v = new vector<Parameter*>;
         ((*yyvalp).parameter_vector_attr) = v;
     }
-#line 1565 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1578 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 47: /* par_decl_item_list: par_decl_item par_decl_item_list  */
-#line 539 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 550 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                       {
         vector<Parameter*>* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.parameter_vector_attr);
         v->emplace(v->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.par_attr));
         ((*yyvalp).parameter_vector_attr) = v;
     }
-#line 1575 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1588 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 48: /* par_decl_item: par_type COLON VAR_PAR_IDENTIFIER EQUALS par_expr SEMICOLON  */
-#line 548 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 559 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         ((*yyvalp).par_attr) = new Parameter((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-5)].yystate.yysemantics.yyval.par_type_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.par_expr_attr));
     }
-#line 1583 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1596 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 49: /* var_decl_item_list: var_decl_item  */
-#line 553 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 564 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                   {
         vector<Variable*>* v = new vector<Variable*>;
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.variable_attr));
         ((*yyvalp).variable_vector_attr) = v;
     }
-#line 1593 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1606 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 50: /* var_decl_item_list: var_decl_item_list var_decl_item  */
-#line 558 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 569 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                        {
         vector<Variable*>* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.variable_vector_attr);
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.variable_attr));
         ((*yyvalp).variable_vector_attr) = v;
     }
-#line 1603 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1616 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 51: /* var_decl_item: basic_var_type COLON VAR_PAR_IDENTIFIER annotations EQUALS basic_expr SEMICOLON  */
-#line 566 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 577 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                                     {
         BasicVar* v = new BasicVar((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-6)].yystate.yysemantics.yyval.basic_var_type_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.basic_expr_attr), false);
         auto annos = *((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.annotation_list_attr));
@@ -1619,11 +1632,11 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
 
         ((*yyvalp).variable_attr) = new Variable(v);
     }
-#line 1623 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1636 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 52: /* var_decl_item: basic_var_type COLON VAR_PAR_IDENTIFIER annotations SEMICOLON  */
-#line 581 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 592 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                     {
         BasicVar* v = new BasicVar((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.basic_var_type_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.str_attr), false);
         auto annos = *((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.annotation_list_attr));
@@ -1639,11 +1652,11 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
 
         ((*yyvalp).variable_attr) = new Variable(v);
     }
-#line 1643 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1656 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 53: /* var_decl_item: array_var_type COLON VAR_PAR_IDENTIFIER annotations EQUALS array_literal SEMICOLON  */
-#line 596 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 607 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                                          {
         ArrayVar* v = new ArrayVar((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-6)].yystate.yysemantics.yyval.array_var_type_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-4)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.array_literal_attr));
         auto annos = *((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.annotation_list_attr));
@@ -1659,31 +1672,31 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
 
         ((*yyvalp).variable_attr) = new Variable(v);
     }
-#line 1663 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1676 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 54: /* constraint_item_list: constraint_item  */
-#line 614 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 625 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<Constraint*>* v = new vector<Constraint*>;
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.constraint_attr));
         ((*yyvalp).constraint_vector_attr) = v;
     }
-#line 1673 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1686 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 55: /* constraint_item_list: constraint_item_list constraint_item  */
-#line 620 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 631 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         vector<Constraint*>* v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.constraint_vector_attr);
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.constraint_attr));
         ((*yyvalp).constraint_vector_attr) = v;
     }
-#line 1683 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1696 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 56: /* constraint_item: CONSTRAINT VAR_PAR_IDENTIFIER OPEN_PARENT_SMALL args_list CLOSED_PARENT_SMALL annotations SEMICOLON  */
-#line 628 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 639 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                                                                         {
         Constraint* c = new Constraint((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-5)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-3)].yystate.yysemantics.yyval.args_list_attr));
 
@@ -1694,152 +1707,152 @@ yyuserAction (yyRuleNum yyrule, int yyrhslen, yyGLRStackItem* yyvsp,
 
         ((*yyvalp).constraint_attr) = c;
     }
-#line 1698 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1711 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 57: /* args_list: expr  */
-#line 641 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 652 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
          {
         ArgsList* a = new ArgsList();
         a->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.expr_attr));
         ((*yyvalp).args_list_attr) = a;
     }
-#line 1708 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1721 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 58: /* args_list: args_list COMMA expr  */
-#line 646 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 657 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                            {
         ArgsList* a = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.args_list_attr);
         a->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.expr_attr));
         ((*yyvalp).args_list_attr) = a;
     }
-#line 1718 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1731 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 59: /* solve_item: SOLVE annotations SOLVE_SATISFY SEMICOLON  */
-#line 654 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 665 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                               { ((*yyvalp).solve_attr) = new Solve(SolveType::ORDINARY); }
-#line 1724 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1737 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 60: /* solve_item: SOLVE SOLVE_MINIMIZE basic_expr SEMICOLON  */
-#line 655 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 666 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                 { ((*yyvalp).solve_attr) = new Solve(SolveType::MINIMIZE, (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.basic_expr_attr)); }
-#line 1730 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1743 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 61: /* solve_item: SOLVE SOLVE_MAXIMIZE basic_expr SEMICOLON  */
-#line 656 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 667 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                 { ((*yyvalp).solve_attr) = new Solve(SolveType::MAXIMIZE, (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.basic_expr_attr)); }
-#line 1736 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1749 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 62: /* annotations: %empty  */
-#line 660 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 671 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         AnnotationList v = new vector<Annotation*>;
         ((*yyvalp).annotation_list_attr) = v;
     }
-#line 1745 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1758 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 63: /* annotations: DOUBLE_COLON annotation annotations  */
-#line 664 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 675 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                           {
         AnnotationList v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.annotation_list_attr);
         v->emplace(v->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.annotation_attr));
         ((*yyvalp).annotation_list_attr) = v;
     }
-#line 1755 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1768 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 64: /* annotation: VAR_PAR_IDENTIFIER  */
-#line 672 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 683 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        {
         ((*yyvalp).annotation_attr) = new Annotation((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.str_attr));
     }
-#line 1763 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1776 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 65: /* annotation: VAR_PAR_IDENTIFIER OPEN_PARENT_SMALL anno_list  */
-#line 675 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 686 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                                      {
         ((*yyvalp).annotation_attr) = new Annotation((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.str_attr), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.anno_list_attr));
     }
-#line 1771 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1784 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 66: /* anno_list: ann_expr CLOSED_PARENT_SMALL  */
-#line 681 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 692 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                  {
         vector<variant<Annotation*, BasicLiteralExpr*>*>* v = new vector<variant<Annotation*, BasicLiteralExpr*>*>();
         v->push_back((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-1)].yystate.yysemantics.yyval.ann_expr_attr));
         ((*yyvalp).anno_list_attr) = v;
     }
-#line 1781 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1794 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 67: /* anno_list: ann_expr COMMA anno_list  */
-#line 686 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 697 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                               {
         auto v = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.anno_list_attr);
         v->emplace(v->begin(), (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (-2)].yystate.yysemantics.yyval.ann_expr_attr));
         ((*yyvalp).anno_list_attr) = v;
     }
-#line 1791 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1804 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 68: /* ann_expr: basic_literal_expr  */
-#line 694 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 705 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                        {
         ((*yyvalp).ann_expr_attr) = new variant<Annotation*, BasicLiteralExpr*>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_literal_expr_attr));
     }
-#line 1799 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1812 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 69: /* ann_expr: annotation  */
-#line 697 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 708 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                  {
         ((*yyvalp).ann_expr_attr) = new variant<Annotation*, BasicLiteralExpr*>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.annotation_attr));
     }
-#line 1807 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1820 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 70: /* ann_expr: OPEN_PARENT_MED basic_anno_list  */
-#line 700 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 711 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                       {
         ((*yyvalp).ann_expr_attr) = new variant<Annotation*, BasicLiteralExpr*>((YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_literal_expr_attr));
     }
-#line 1815 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1828 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 71: /* basic_anno_list: %empty  */
-#line 706 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 717 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
     {
         ((*yyvalp).basic_literal_expr_attr) = new BasicLiteralExpr(0);
     }
-#line 1823 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1836 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 72: /* basic_anno_list: ann_expr COMMA basic_anno_list  */
-#line 709 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 720 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                      {
         ((*yyvalp).basic_literal_expr_attr) = (YY_CAST (yyGLRStackItem const *, yyvsp)[YYFILL (0)].yystate.yysemantics.yyval.basic_literal_expr_attr);
     }
-#line 1831 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1844 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
   case 73: /* basic_anno_list: ann_expr CLOSED_PARENT_MED  */
-#line 712 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 723 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
                                  {
         ((*yyvalp).basic_literal_expr_attr) = new BasicLiteralExpr(0);
     }
-#line 1839 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1852 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
     break;
 
 
-#line 1843 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
+#line 1856 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/src/parser.cpp"
 
       default: break;
     }
@@ -1878,9 +1891,11 @@ yyuserMerge (int yyn, YYSTYPE* yy0, YYSTYPE* yy1)
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, vector<Item>* parsing_result, yyscan_t scanner)
 {
   YY_USE (yyvaluep);
+  YY_USE (parsing_result);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
@@ -1898,11 +1913,11 @@ yyrhsLength (yyRuleNum yyrule)
 }
 
 static void
-yydestroyGLRState (char const *yymsg, yyGLRState *yys)
+yydestroyGLRState (char const *yymsg, yyGLRState *yys, vector<Item>* parsing_result, yyscan_t scanner)
 {
   if (yys->yyresolved)
     yydestruct (yymsg, yy_accessing_symbol (yys->yylrState),
-                &yys->yysemantics.yyval);
+                &yys->yysemantics.yyval, parsing_result, scanner);
   else
     {
 #if YYDEBUG
@@ -1924,7 +1939,7 @@ yydestroyGLRState (char const *yymsg, yyGLRState *yys)
           for (yyrh = yyoption->yystate, yyn = yyrhsLength (yyoption->yyrule);
                yyn > 0;
                yyrh = yyrh->yypred, yyn -= 1)
-            yydestroyGLRState (yymsg, yyrh);
+            yydestroyGLRState (yymsg, yyrh, parsing_result, scanner);
         }
     }
 }
@@ -2304,7 +2319,7 @@ yyglrShiftDefer (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yy_state_t yylrState,
 
 static inline void
 yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
-                 yyRuleNum yyrule)
+                 yyRuleNum yyrule, vector<Item>* parsing_result, yyscan_t scanner)
 {
   int yynrhs = yyrhsLength (yyrule);
   int yyi;
@@ -2318,7 +2333,7 @@ yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
       YY_FPRINTF ((stderr, "   $%d = ", yyi + 1));
       yy_symbol_print (stderr,
                        yy_accessing_symbol (yyvsp[yyi - yynrhs + 1].yystate.yylrState),
-                       &yyvsp[yyi - yynrhs + 1].yystate.yysemantics.yyval                       );
+                       &yyvsp[yyi - yynrhs + 1].yystate.yysemantics.yyval                       , parsing_result, scanner);
       if (!yyvsp[yyi - yynrhs + 1].yystate.yyresolved)
         YY_FPRINTF ((stderr, " (unresolved)"));
       YY_FPRINTF ((stderr, "\n"));
@@ -2334,7 +2349,7 @@ yy_reduce_print (yybool yynormal, yyGLRStackItem* yyvsp, YYPTRDIFF_T yyk,
  *  for userAction.  */
 static inline YYRESULTTAG
 yydoAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
-            YYSTYPE* yyvalp)
+            YYSTYPE* yyvalp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   int yynrhs = yyrhsLength (yyrule);
 
@@ -2348,7 +2363,7 @@ yydoAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
       yystackp->yyspaceLeft += yynrhs;
       yystackp->yytops.yystates[0] = & yystackp->yynextFree[-1].yystate;
       return yyuserAction (yyrule, yynrhs, yyrhs, yystackp, yyk,
-                           yyvalp);
+                           yyvalp, parsing_result, scanner);
     }
   else
     {
@@ -2364,7 +2379,7 @@ yydoAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
       yyupdateSplit (yystackp, yys);
       yystackp->yytops.yystates[yyk] = yys;
       return yyuserAction (yyrule, yynrhs, yyrhsVals + YYMAXRHS + YYMAXLEFT - 1,
-                           yystackp, yyk, yyvalp);
+                           yystackp, yyk, yyvalp, parsing_result, scanner);
     }
 }
 
@@ -2381,7 +2396,7 @@ yydoAction (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
  */
 static inline YYRESULTTAG
 yyglrReduce (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
-             yybool yyforceEval)
+             yybool yyforceEval, vector<Item>* parsing_result, yyscan_t scanner)
 {
   YYPTRDIFF_T yyposn = yystackp->yytops.yystates[yyk]->yyposn;
 
@@ -2389,7 +2404,7 @@ yyglrReduce (yyGLRStack* yystackp, YYPTRDIFF_T yyk, yyRuleNum yyrule,
     {
       YYSTYPE yyval;
 
-      YYRESULTTAG yyflag = yydoAction (yystackp, yyk, yyrule, &yyval);
+      YYRESULTTAG yyflag = yydoAction (yystackp, yyk, yyrule, &yyval, parsing_result, scanner);
       if (yyflag == yyerr && yystackp->yysplitPoint != YY_NULLPTR)
         YY_DPRINTF ((stderr,
                      "Parse on stack %ld rejected by rule %d (line %d).\n",
@@ -2590,7 +2605,7 @@ yypreference (yySemanticOption* y0, yySemanticOption* y1)
 }
 
 static YYRESULTTAG
-yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp);
+yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner);
 
 
 /** Resolve the previous YYN states starting at and including state YYS
@@ -2600,14 +2615,14 @@ yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp);
  *  data so that yydestroyGLRState can be invoked if necessary.  */
 static YYRESULTTAG
 yyresolveStates (yyGLRState* yys, int yyn,
-                 yyGLRStack* yystackp)
+                 yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   if (0 < yyn)
     {
       YY_ASSERT (yys->yypred);
-      YYCHK (yyresolveStates (yys->yypred, yyn-1, yystackp));
+      YYCHK (yyresolveStates (yys->yypred, yyn-1, yystackp, parsing_result, scanner));
       if (! yys->yyresolved)
-        YYCHK (yyresolveValue (yys, yystackp));
+        YYCHK (yyresolveValue (yys, yystackp, parsing_result, scanner));
     }
   return yyok;
 }
@@ -2619,17 +2634,17 @@ yyresolveStates (yyGLRState* yys, int yyn,
  *  semantic values if invoked).  */
 static YYRESULTTAG
 yyresolveAction (yySemanticOption* yyopt, yyGLRStack* yystackp,
-                 YYSTYPE* yyvalp)
+                 YYSTYPE* yyvalp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   yyGLRStackItem yyrhsVals[YYMAXRHS + YYMAXLEFT + 1];
   int yynrhs = yyrhsLength (yyopt->yyrule);
   YYRESULTTAG yyflag =
-    yyresolveStates (yyopt->yystate, yynrhs, yystackp);
+    yyresolveStates (yyopt->yystate, yynrhs, yystackp, parsing_result, scanner);
   if (yyflag != yyok)
     {
       yyGLRState *yys;
       for (yys = yyopt->yystate; yynrhs > 0; yys = yys->yypred, yynrhs -= 1)
-        yydestroyGLRState ("Cleanup: popping", yys);
+        yydestroyGLRState ("Cleanup: popping", yys, parsing_result, scanner);
       return yyflag;
     }
 
@@ -2641,7 +2656,7 @@ yyresolveAction (yySemanticOption* yyopt, yyGLRStack* yystackp,
     yylval = yyopt->yyval;
     yyflag = yyuserAction (yyopt->yyrule, yynrhs,
                            yyrhsVals + YYMAXRHS + YYMAXLEFT - 1,
-                           yystackp, -1, yyvalp);
+                           yystackp, -1, yyvalp, parsing_result, scanner);
     yychar = yychar_current;
     yylval = yylval_current;
   }
@@ -2698,7 +2713,7 @@ yyreportTree (yySemanticOption* yyx, int yyindent)
 
 static YYRESULTTAG
 yyreportAmbiguity (yySemanticOption* yyx0,
-                   yySemanticOption* yyx1)
+                   yySemanticOption* yyx1, vector<Item>* parsing_result, yyscan_t scanner)
 {
   YY_USE (yyx0);
   YY_USE (yyx1);
@@ -2712,7 +2727,7 @@ yyreportAmbiguity (yySemanticOption* yyx0,
   YY_FPRINTF ((stderr, "\n"));
 #endif
 
-  yyerror (YY_("syntax is ambiguous"));
+  yyerror (parsing_result, scanner, YY_("syntax is ambiguous"));
   return yyabort;
 }
 
@@ -2724,7 +2739,7 @@ yyreportAmbiguity (yySemanticOption* yyx0,
  *  result = yyok, YYS has been left with consistent data so that
  *  yydestroyGLRState can be invoked if necessary.  */
 static YYRESULTTAG
-yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp)
+yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   yySemanticOption* yyoptionList = yys->yysemantics.yyfirstVal;
   yySemanticOption* yybest = yyoptionList;
@@ -2747,7 +2762,7 @@ yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp)
           switch (yypreference (yybest, yyp))
             {
             case 0:
-              return yyreportAmbiguity (yybest, yyp);
+              return yyreportAmbiguity (yybest, yyp, parsing_result, scanner);
               break;
             case 1:
               yymerge = yytrue;
@@ -2772,19 +2787,19 @@ yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp)
     {
       yySemanticOption* yyp;
       int yyprec = yydprec[yybest->yyrule];
-      yyflag = yyresolveAction (yybest, yystackp, &yyval);
+      yyflag = yyresolveAction (yybest, yystackp, &yyval, parsing_result, scanner);
       if (yyflag == yyok)
         for (yyp = yybest->yynext; yyp != YY_NULLPTR; yyp = yyp->yynext)
           {
             if (yyprec == yydprec[yyp->yyrule])
               {
                 YYSTYPE yyval_other;
-                yyflag = yyresolveAction (yyp, yystackp, &yyval_other);
+                yyflag = yyresolveAction (yyp, yystackp, &yyval_other, parsing_result, scanner);
                 if (yyflag != yyok)
                   {
                     yydestruct ("Cleanup: discarding incompletely merged value for",
                                 yy_accessing_symbol (yys->yylrState),
-                                &yyval);
+                                &yyval, parsing_result, scanner);
                     break;
                   }
                 yyuserMerge (yymerger[yyp->yyrule], &yyval, &yyval_other);
@@ -2792,7 +2807,7 @@ yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp)
           }
     }
   else
-    yyflag = yyresolveAction (yybest, yystackp, &yyval);
+    yyflag = yyresolveAction (yybest, yystackp, &yyval, parsing_result, scanner);
 
   if (yyflag == yyok)
     {
@@ -2805,7 +2820,7 @@ yyresolveValue (yyGLRState* yys, yyGLRStack* yystackp)
 }
 
 static YYRESULTTAG
-yyresolveStack (yyGLRStack* yystackp)
+yyresolveStack (yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   if (yystackp->yysplitPoint != YY_NULLPTR)
     {
@@ -2817,7 +2832,7 @@ yyresolveStack (yyGLRStack* yystackp)
            yys = yys->yypred, yyn += 1)
         continue;
       YYCHK (yyresolveStates (yystackp->yytops.yystates[0], yyn, yystackp
-                             ));
+                             , parsing_result, scanner));
     }
   return yyok;
 }
@@ -2860,7 +2875,7 @@ yycompressStack (yyGLRStack* yystackp)
 
 static YYRESULTTAG
 yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
-                   YYPTRDIFF_T yyposn)
+                   YYPTRDIFF_T yyposn, vector<Item>* parsing_result, yyscan_t scanner)
 {
   while (yystackp->yytops.yystates[yyk] != YY_NULLPTR)
     {
@@ -2880,7 +2895,7 @@ yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
               yymarkStackDeleted (yystackp, yyk);
               return yyok;
             }
-          yyflag = yyglrReduce (yystackp, yyk, yyrule, yyimmediate[yyrule]);
+          yyflag = yyglrReduce (yystackp, yyk, yyrule, yyimmediate[yyrule], parsing_result, scanner);
           if (yyflag == yyerr)
             {
               YY_DPRINTF ((stderr,
@@ -2895,7 +2910,7 @@ yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
         }
       else
         {
-          yysymbol_kind_t yytoken = yygetToken (&yychar);
+          yysymbol_kind_t yytoken = yygetToken (&yychar, yystackp, parsing_result, scanner);
           const short* yyconflicts;
           const int yyaction = yygetLRActions (yystate, yytoken, &yyconflicts);
           yystackp->yytops.yylookaheadNeeds[yyk] = yytrue;
@@ -2908,10 +2923,10 @@ yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
                            YY_CAST (long, yynewStack), YY_CAST (long, yyk)));
               yyflag = yyglrReduce (yystackp, yynewStack,
                                     *yyconflicts,
-                                    yyimmediate[*yyconflicts]);
+                                    yyimmediate[*yyconflicts], parsing_result, scanner);
               if (yyflag == yyok)
                 YYCHK (yyprocessOneStack (yystackp, yynewStack,
-                                          yyposn));
+                                          yyposn, parsing_result, scanner));
               else if (yyflag == yyerr)
                 {
                   YY_DPRINTF ((stderr, "Stack %ld dies.\n", YY_CAST (long, yynewStack)));
@@ -2932,7 +2947,7 @@ yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
           else
             {
               YYRESULTTAG yyflag = yyglrReduce (yystackp, yyk, -yyaction,
-                                                yyimmediate[-yyaction]);
+                                                yyimmediate[-yyaction], parsing_result, scanner);
               if (yyflag == yyerr)
                 {
                   YY_DPRINTF ((stderr,
@@ -2956,11 +2971,11 @@ yyprocessOneStack (yyGLRStack* yystackp, YYPTRDIFF_T yyk,
 
 
 static void
-yyreportSyntaxError (yyGLRStack* yystackp)
+yyreportSyntaxError (yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   if (yystackp->yyerrState != 0)
     return;
-  yyerror (YY_("syntax error"));
+  yyerror (parsing_result, scanner, YY_("syntax error"));
   yynerrs += 1;
 }
 
@@ -2968,7 +2983,7 @@ yyreportSyntaxError (yyGLRStack* yystackp)
    yylval, and yylloc are the syntactic category, semantic value, and location
    of the lookahead.  */
 static void
-yyrecoverSyntaxError (yyGLRStack* yystackp)
+yyrecoverSyntaxError (yyGLRStack* yystackp, vector<Item>* parsing_result, yyscan_t scanner)
 {
   if (yystackp->yyerrState == 3)
     /* We just shifted the error token and (perhaps) took some
@@ -2978,15 +2993,15 @@ yyrecoverSyntaxError (yyGLRStack* yystackp)
         yysymbol_kind_t yytoken;
         int yyj;
         if (yychar == YYEOF)
-          yyFail (yystackp, YY_NULLPTR);
+          yyFail (yystackp, parsing_result, scanner, YY_NULLPTR);
         if (yychar != YYEMPTY)
           {
             yytoken = YYTRANSLATE (yychar);
             yydestruct ("Error: discarding",
-                        yytoken, &yylval);
+                        yytoken, &yylval, parsing_result, scanner);
             yychar = YYEMPTY;
           }
-        yytoken = yygetToken (&yychar);
+        yytoken = yygetToken (&yychar, yystackp, parsing_result, scanner);
         yyj = yypact[yystackp->yytops.yystates[0]->yylrState];
         if (yypact_value_is_default (yyj))
           return;
@@ -3007,7 +3022,7 @@ yyrecoverSyntaxError (yyGLRStack* yystackp)
       if (yystackp->yytops.yystates[yyk] != YY_NULLPTR)
         break;
     if (yyk >= yystackp->yytops.yysize)
-      yyFail (yystackp, YY_NULLPTR);
+      yyFail (yystackp, parsing_result, scanner, YY_NULLPTR);
     for (yyk += 1; yyk < yystackp->yytops.yysize; yyk += 1)
       yymarkStackDeleted (yystackp, yyk);
     yyremoveDeletes (yystackp);
@@ -3037,13 +3052,13 @@ yyrecoverSyntaxError (yyGLRStack* yystackp)
             }
         }
       if (yys->yypred != YY_NULLPTR)
-        yydestroyGLRState ("Error: popping", yys);
+        yydestroyGLRState ("Error: popping", yys, parsing_result, scanner);
       yystackp->yytops.yystates[0] = yys->yypred;
       yystackp->yynextFree -= 1;
       yystackp->yyspaceLeft += 1;
     }
   if (yystackp->yytops.yystates[0] == YY_NULLPTR)
-    yyFail (yystackp, YY_NULLPTR);
+    yyFail (yystackp, parsing_result, scanner, YY_NULLPTR);
 }
 
 #define YYCHK1(YYE)                             \
@@ -3063,7 +3078,7 @@ yyrecoverSyntaxError (yyGLRStack* yystackp)
 `----------*/
 
 int
-yyparse (void)
+yyparse (vector<Item>* parsing_result, yyscan_t scanner)
 {
   int yyresult;
   yyGLRStack yystack;
@@ -3104,14 +3119,14 @@ yyparse (void)
               yyRuleNum yyrule = yydefaultAction (yystate);
               if (yyrule == 0)
                 {
-                  yyreportSyntaxError (&yystack);
+                  yyreportSyntaxError (&yystack, parsing_result, scanner);
                   goto yyuser_error;
                 }
-              YYCHK1 (yyglrReduce (&yystack, 0, yyrule, yytrue));
+              YYCHK1 (yyglrReduce (&yystack, 0, yyrule, yytrue, parsing_result, scanner));
             }
           else
             {
-              yysymbol_kind_t yytoken = yygetToken (&yychar);
+              yysymbol_kind_t yytoken = yygetToken (&yychar, yystackp, parsing_result, scanner);
               const short* yyconflicts;
               int yyaction = yygetLRActions (yystate, yytoken, &yyconflicts);
               if (*yyconflicts)
@@ -3131,11 +3146,11 @@ yyparse (void)
                   /* Issue an error message unless the scanner already
                      did. */
                   if (yychar != YYerror)
-                    yyreportSyntaxError (&yystack);
+                    yyreportSyntaxError (&yystack, parsing_result, scanner);
                   goto yyuser_error;
                 }
               else
-                YYCHK1 (yyglrReduce (&yystack, 0, -yyaction, yytrue));
+                YYCHK1 (yyglrReduce (&yystack, 0, -yyaction, yytrue, parsing_result, scanner));
             }
         }
 
@@ -3168,16 +3183,16 @@ yyparse (void)
              on yylval in the event of memory exhaustion.  */
 
           for (yys = 0; yys < yystack.yytops.yysize; yys += 1)
-            YYCHK1 (yyprocessOneStack (&yystack, yys, yyposn));
+            YYCHK1 (yyprocessOneStack (&yystack, yys, yyposn, parsing_result, scanner));
           yyremoveDeletes (&yystack);
           if (yystack.yytops.yysize == 0)
             {
               yyundeleteLastStack (&yystack);
               if (yystack.yytops.yysize == 0)
-                yyFail (&yystack, YY_("syntax error"));
-              YYCHK1 (yyresolveStack (&yystack));
+                yyFail (&yystack, parsing_result, scanner, YY_("syntax error"));
+              YYCHK1 (yyresolveStack (&yystack, parsing_result, scanner));
               YY_DPRINTF ((stderr, "Returning to deterministic operation.\n"));
-              yyreportSyntaxError (&yystack);
+              yyreportSyntaxError (&yystack, parsing_result, scanner);
               goto yyuser_error;
             }
 
@@ -3207,7 +3222,7 @@ yyparse (void)
 
           if (yystack.yytops.yysize == 1)
             {
-              YYCHK1 (yyresolveStack (&yystack));
+              YYCHK1 (yyresolveStack (&yystack, parsing_result, scanner));
               YY_DPRINTF ((stderr, "Returning to deterministic operation.\n"));
               yycompressStack (&yystack);
               break;
@@ -3215,7 +3230,7 @@ yyparse (void)
         }
       continue;
     yyuser_error:
-      yyrecoverSyntaxError (&yystack);
+      yyrecoverSyntaxError (&yystack, parsing_result, scanner);
       yyposn = yystack.yytops.yystates[0]->yyposn;
     }
 
@@ -3232,14 +3247,14 @@ yyparse (void)
   goto yyreturnlab;
 
  yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (parsing_result, scanner, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
  yyreturnlab:
   if (yychar != YYEMPTY)
     yydestruct ("Cleanup: discarding lookahead",
-                YYTRANSLATE (yychar), &yylval);
+                YYTRANSLATE (yychar), &yylval, parsing_result, scanner);
 
   /* If the stack is well-formed, pop the stack until it is empty,
      destroying its entries as we go.  But free the stack regardless
@@ -3258,7 +3273,7 @@ yyparse (void)
                   {
                     yyGLRState *yys = yystates[yyk];
                     if (yys->yypred != YY_NULLPTR)
-                      yydestroyGLRState ("Cleanup: popping", yys);
+                      yydestroyGLRState ("Cleanup: popping", yys, parsing_result, scanner);
                     yystates[yyk] = yys->yypred;
                     yystack.yynextFree -= 1;
                     yystack.yyspaceLeft += 1;
@@ -3362,6 +3377,9 @@ yypdumpstack (yyGLRStack* yystackp)
 
 
 
-#line 715 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
+#line 726 "/home/ubuntu/Desktop/Studije/MasterRad/FlatZincToSATConverter/parser_gen/parser.ypp"
 
- 
+
+void yyerror(vector<Item>*, yyscan_t, const char* message){
+    printf("%s", message);
+}